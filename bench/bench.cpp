@@ -0,0 +1,355 @@
+// File: bench/bench.cpp
+// Headless benchmark of the engine: no window and no GL.
+// g++ -O2 -I. bench/bench.cpp -o tictactoe-bench -pthread
+// Options as in the game: --tt-mb 64  --threads 4  --move-ms 500  --book tictactoe.book
+// The search is measured without the opening book unless --book is given.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+
+#include "engine/engine.h"
+
+using namespace std;
+
+// ---------- Benchmark ----------
+struct BenchCase {
+    const char* name;
+    int n;
+    vector<pair<int,int>> moves;   // (row,col) played alternately from X
+};
+
+// Fixed-size engine against the generic one from the same position, depth and
+// (empty) table: moves, values and node counts must agree. Each search is
+// repeated until 0.2s of search time has been measured.
+template <int N>
+void compareFixed(int depth, const vector<pair<int,int>> &moves) {
+    Position pos;
+    pos.reset(N);
+    for (size_t k=0;k<moves.size();k++) pos.makeMove(moves[k].first*N + moves[k].second, k%2 == 0 ? 1 : 2);
+    auto timeSearch = [&](auto makeSearcher, SearchResult &r) {
+        double total = 0;
+        int runs = 0;
+        while (total < 0.2) {
+            transTable.clear();
+            auto s = makeSearcher();
+            s.maxDepth = depth;
+            auto start = chrono::steady_clock::now();
+            r = s.findBestMove();
+            total += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            runs++;
+        }
+        return total / runs;
+    };
+    SearchResult generic, fixed;
+    double genericSec = timeSearch([&]{ return Searcher(pos); }, generic);
+    double fixedSec = timeSearch([&]{ return FixedSearcher<N>(FixedPosition<N>(pos)); }, fixed);
+    char depthText[16] = "full";
+    if (depth < MAX_CELLS) snprintf(depthText, sizeof(depthText), "%d", depth);
+    printf("%dx%d  %-2zu plies depth %-4s generic=%9.5fs  fixed=%9.5fs  speedup=%5.2fx  nodes=%-9lld %s\n",
+           N, N, moves.size(), depthText, genericSec, fixedSec, genericSec / max(fixedSec, 1e-12), fixed.nodes,
+           fixed.cell == generic.cell && fixed.value == generic.value && fixed.nodes == generic.nodes ? "ok" : "MISMATCH");
+}
+
+// Batch evaluation of random positions with each kernel the CPU has; every
+// kernel must reproduce Position's own result and heuristic.
+void benchBatchEval() {
+    struct Shape { int rows, cols, k; };
+    const Shape shapes[] = {{3, 3, 3}, {4, 4, 4}, {8, 8, 8}, {8, 8, 5}};
+    const int COUNT = 1 << 16;
+    printf("\nbatch evaluation (%d positions per batch)\n", COUNT);
+    for (const Shape &sh : shapes) {
+        vector<unsigned long long> x(COUNT), o(COUNT);
+        vector<signed char> wantResult(COUNT), result(COUNT);
+        vector<int> wantHeuristic(COUNT), heuristic(COUNT);
+        srand(777);
+        for (int i=0;i<COUNT;i++) {
+            Position pos;
+            pos.reset(sh.rows, sh.cols, sh.k);
+            int plies = rand() % (pos.emptyCount + 1);
+            for (int p=1, ply=0; ply<plies && !pos.hasWon(1) && !pos.hasWon(2); ply++, p = 3-p) {
+                int free[MAX_CELLS], count = 0;
+                for (Mask m = pos.emptyCells(); m; m.clearLowest()) free[count++] = lowestBit(m);
+                pos.makeMove(free[rand() % count], p);
+            }
+            x[i] = pos.bb[1].w[0];
+            o[i] = pos.bb[2].w[0];
+            wantResult[i] = pos.hasWon(2) ? RESULT_O_WINS : pos.hasWon(1) ? RESULT_X_WINS : pos.isFull() ? RESULT_DRAW : RESULT_NONE;
+            wantHeuristic[i] = pos.heuristic;
+        }
+        BatchEvaluator eval(sh.rows, sh.cols, sh.k);
+        for (EvalKernel kernel : {EVAL_SCALAR, EVAL_SSE41, EVAL_AVX2}) {
+            if (!evalKernelSupported(kernel)) {
+                printf("%dx%d k=%d  %-7s not supported on this CPU\n", sh.rows, sh.cols, sh.k, EVAL_KERNEL_NAMES[kernel]);
+                continue;
+            }
+            double sec = 0;
+            long long evaluated = 0;
+            while (sec < 0.2) {
+                auto start = chrono::steady_clock::now();
+                eval.evaluate(x.data(), o.data(), COUNT, result.data(), heuristic.data(), kernel);
+                sec += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                evaluated += COUNT;
+            }
+            bool ok = result == wantResult && heuristic == wantHeuristic;
+            printf("%dx%d k=%d  %-7s positions/sec=%12.0f  %s\n", sh.rows, sh.cols, sh.k, EVAL_KERNEL_NAMES[kernel],
+                   evaluated / max(sec, 1e-9), ok ? "ok" : "MISMATCH");
+        }
+    }
+}
+
+// Monte Carlo tree search from the middle of a game on the larger boards: playouts
+// per second with one thread and with --threads, and how much of the tree the
+// next move starts with after X's reply
+void benchMcts(int moveTimeMs) {
+    printf("\nMCTS (%d ms per move)\n", moveTimeMs);
+    vector<int> threadCounts = {1};
+    if (searchThreads > 1) threadCounts.push_back(searchThreads);
+    for (int n=6;n<=10;n++) {
+        for (int threads : threadCounts) {
+            Position pos;
+            pos.reset(n);
+            const int centre = (n/2)*n + n/2;
+            pos.makeMove(centre, 1);
+            pos.makeMove(centre - 1, 2);
+            pos.makeMove(centre - n, 1);
+            MctsSearcher mcts;
+            SearchControl control;
+            control.timeLimit = moveTimeMs / 1000.0;
+            control.start();
+            SearchResult r = mcts.search(pos, &control, threads);
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - control.started).count();
+            const int treeAfter = mcts.treeSize();
+            pos.makeMove(r.cell, 2);
+            int reply = lowestBit(pos.emptyCells());
+            pos.makeMove(reply, 1);
+            control.timeLimit = 0;
+            control.nodeLimit = MCTS_BATCH;
+            control.start();
+            mcts.search(pos, &control, threads);
+            printf("%2dx%-2d threads=%-2d time=%7.3fs  playouts=%-9lld playouts/sec=%10.0f  tree=%-8d kept=%-8d move=(%d,%d) value=%d\n",
+                   n, n, threads, sec, r.nodes, r.nodes / max(sec, 1e-9), treeAfter, mcts.treeSize(),
+                   r.cell / n, r.cell % n, r.value);
+        }
+    }
+}
+
+// df-pn against alpha-beta on the positions where the side to move has a
+// forced win: random games some plies in, with a fixed seed. Both must call
+// every one of them a win.
+void benchProof() {
+    struct ProofCase { int n, k, plies, games; };
+    printf("\nproof-number search on forced wins (alpha-beta solves the same positions)\n");
+    for (ProofCase c : {ProofCase{4, 4, 8, 300}, ProofCase{5, 4, 6, 20}, ProofCase{5, 4, 8, 40}}) {
+        srand(7);
+        ProofSolver solver(64);
+        solver.nodeLimit = 2000000;
+        long long proofNodes = 0, searchNodes = 0;
+        double proofSec = 0, searchSec = 0;
+        int wins = 0, agreed = 0;
+        for (int game=0; game<c.games; game++) {
+            Game g(c.n, c.n, c.k);
+            for (int i=0;i<c.plies && !g.over;i++) {
+                int moves[MAX_CELLS];
+                g.play(moves[rand() % g.legalMoves(moves)]);
+            }
+            if (g.over) continue;
+            solver.table.clear();
+            solver.nodes = 0;
+            int cell;
+            auto start = chrono::steady_clock::now();
+            const bool won = solver.findForcedWin(g.pos, g.toMove, cell);
+            const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (!won) continue;
+            transTable.clear();
+            start = chrono::steady_clock::now();
+            SearchResult r = findBestMoveFor(g.pos, g.toMove);
+            searchSec += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            proofSec += sec;
+            proofNodes += solver.nodes;
+            searchNodes += r.nodes;
+            wins++;
+            agreed += r.value > WIN_SCORE - 1000;
+        }
+        printf("%dx%d k=%d %d plies  wins=%-4d df-pn nodes=%-10lld time=%7.3fs  alpha-beta nodes=%-10lld time=%7.3fs  %s\n",
+               c.n, c.n, c.k, c.plies, wins, proofNodes, proofSec, searchNodes, searchSec,
+               agreed == wins ? "ok" : "MISMATCH");
+    }
+}
+
+// Search cache: the same positions searched cold, then answered from a
+// fresh cache file that the first pass filled (symmetric first moves hit it
+// already). Removed afterwards.
+void benchCache() {
+    const char* path = "tictactoe-bench.cache";
+    remove(path);
+    if (!searchCache.open(path, 4)) { printf("\nsearch cache: cannot create %s\n", path); return; }
+    printf("\nsearch cache (%zu KB)\n", searchCache.sizeBytes() / 1024);
+    for (int pass=0; pass<2; pass++) {
+        long long nodes = 0;
+        int positions = 0;
+        auto start = chrono::steady_clock::now();
+        for (int first=0; first<16; first++) {
+            if (pass == 0) transTable.clear();
+            Game g(4, 4, 4);
+            g.play(first);
+            nodes += searchBestMove(g.pos).nodes;
+            positions++;
+        }
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%-5s 4x4 after each first move  positions=%-3d nodes=%-10lld time=%8.4fs  per position=%9.1fus\n",
+               pass ? "warm" : "cold", positions, nodes, sec, sec / positions * 1e6);
+    }
+    printf("hits=%lld stores=%lld\n", searchCache.hits.load(), searchCache.stores.load());
+    searchCache.close();
+    remove(path);
+}
+
+void runBenchmark(int moveTimeMs) {
+    vector<BenchCase> cases = {
+        {"3x3 empty",          3, {}},
+        {"3x3 X corner",       3, {{0,0}}},
+        {"4x4 after 5 plies",  4, {{0,0},{1,1},{3,3},{2,2},{0,3}}},
+        {"4x4 after 3 plies",  4, {{0,0},{1,1},{3,3}}},
+        {"4x4 empty",          4, {}},
+    };
+    printf("transposition table: %zu KB\n", transTable.sizeBytes() / 1024);
+    for (auto &c : cases) {
+        transTable.clear();
+        Game g(c.n);
+        for (auto &m : c.moves) g.play(m.first*c.n + m.second);
+        auto start = chrono::steady_clock::now();
+        SearchResult r = searchBestMove(g.pos);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%-20s nodes=%-10lld time=%8.4fs  nodes/sec=%12.0f  move=(%d,%d)  tt hits=%lld misses=%lld\n",
+               c.name, r.nodes, sec, r.nodes / max(sec, 1e-9), r.cell / c.n, r.cell % c.n,
+               r.ttHits, r.ttMisses);
+    }
+
+    // Thread scaling: each run starts from an empty table and must agree with the serial search
+    vector<BenchCase> scaling = {
+        {"4x4 empty",          4, {}},
+        {"5x5 after 6 plies",  5, {{2,2},{0,0},{1,1},{3,3},{0,4},{4,0}}},
+    };
+    int maxThreads = max(4, (int)thread::hardware_concurrency());
+    printf("\nthread scaling (hardware threads: %u)\n", thread::hardware_concurrency());
+    for (auto &c : scaling) {
+        Position pos;
+        pos.reset(c.n);
+        for (size_t k=0;k<c.moves.size();k++) pos.makeMove(c.moves[k].first*c.n + c.moves[k].second, k%2 == 0 ? 1 : 2);
+        transTable.clear();
+        auto start = chrono::steady_clock::now();
+        Searcher serial(pos);
+        SearchResult ref = serial.findBestMove();
+        double serialSec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("%-20s serial    time=%8.4fs  nodes=%-10lld move=%d value=%d\n",
+               c.name, serialSec, ref.nodes, ref.cell, ref.value);
+        for (int threads=1; threads<=maxThreads; threads*=2) {
+            transTable.clear();
+            start = chrono::steady_clock::now();
+            SearchResult r = parallelFindBestMove(pos, threads);
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            printf("%-20s threads=%-2d time=%8.4fs  nodes=%-10lld speedup=%5.2fx  move=%d value=%d %s\n",
+                   c.name, threads, sec, r.nodes, serialSec / max(sec, 1e-9), r.cell, r.value,
+                   r.cell == ref.cell && r.value == ref.value ? "ok" : "MISMATCH");
+        }
+    }
+
+    // Compile-time board sizes against the generic engine
+    printf("\nfixed-size engines (serial)\n");
+    compareFixed<3>(MAX_CELLS, {});
+    compareFixed<4>(MAX_CELLS, {});
+    compareFixed<5>(8, {});
+    compareFixed<6>(6, {});
+    compareFixed<7>(5, {});
+    compareFixed<8>(5, {});
+
+    // Time-bounded iterative deepening, one move per board: every square size the
+    // game offers from empty, then Gomoku (15x15, five in a row) early in a game
+    struct TimedCase { int rows, cols, k; vector<pair<int,int>> moves; };
+    vector<TimedCase> timed;
+    for (int n=3;n<=10;n++) timed.push_back({n, n, n, {}});
+    timed.push_back({15, 15, 5, {}});
+    timed.push_back({15, 15, 5, {{7,7},{7,8},{8,8},{6,6},{8,6}}});
+    printf("\ntime-bounded search (%d ms per move)\n", moveTimeMs);
+    for (auto &c : timed) {
+        Position pos;
+        pos.reset(c.rows, c.cols, c.k);
+        for (size_t m=0;m<c.moves.size();m++) pos.makeMove(c.moves[m].first*c.cols + c.moves[m].second, m%2 == 0 ? 1 : 2);
+        transTable.clear();
+        SearchControl control;
+        control.timeLimit = moveTimeMs / 1000.0;
+        control.start();
+        SearchResult r = searchBestMove(pos, &control);
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - control.started).count();
+        printf("%dx%-2d k=%-2d %-2zu plies  time=%7.3fs  depth=%-3d nodes=%-10lld move=(%d,%d) value=%d\n",
+               c.rows, c.cols, c.k, c.moves.size(), sec, r.depth, r.nodes, r.cell / c.cols, r.cell % c.cols, r.value);
+    }
+
+    benchBatchEval();
+    benchMcts(moveTimeMs);
+    benchProof();
+    benchCache();
+
+    // Game pool: starting a game is a reset in place, with no allocation
+    {
+        GamePool pool(1024);
+        const int ROUNDS = 100;
+        auto start = chrono::steady_clock::now();
+        for (int round=0; round<ROUNDS; round++) {
+            for (int i=0;i<pool.capacity();i++) pool.acquire(15, 15, 5)->play(7*15 + 7);
+            for (int i=0;i<pool.capacity();i++) pool.release(pool.at(i));
+        }
+        double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        printf("\ngame pool: %d slots, %.0f ns per 15x15 acquire + move + release\n",
+               pool.capacity(), sec / ((double)ROUNDS * pool.capacity()) * 1e9);
+    }
+
+    // Opening book (with --book): probe cost, and agreement with the search on random games
+    for (int n=3;n<=BOOK_MAX_N;n++) {
+        if (!openingBook.covers(n)) continue;
+        if (n == 3) printf("\nopening book\n");
+        srand(12345);
+        int checked = 0, agreed = 0;
+        double probeSec = 0;
+        for (int game=0; game<40; game++) {
+            Position pos;
+            pos.reset(n);
+            for (int p=1; !pos.isFull(); p = 3-p) {
+                int free[MAX_CELLS], count = 0;
+                for (Mask m = pos.emptyCells(); m; m.clearLowest()) free[count++] = lowestBit(m);
+                if (p == 2) {
+                    SearchResult book;
+                    auto start = chrono::steady_clock::now();
+                    bool hit = openingBook.probe(pos, book);
+                    probeSec += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                    transTable.clear();
+                    SearchResult r = searchPosition(pos);
+                    checked++;
+                    if (hit && book.cell == r.cell && book.value == r.value) agreed++;
+                }
+                if (pos.makeMove(free[rand() % count], p)) break;
+            }
+        }
+        printf("%dx%d  probes=%-5d agree with search=%-5d avg probe=%6.2fus\n",
+               n, n, checked, agreed, probeSec / max(checked, 1) * 1e6);
+    }
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    int moveTimeMs = 1000;
+    for (int i=1;i<argc;i++) {
+        if (strcmp(argv[i], "--tt-mb") == 0 && i+1 < argc) transTable.resize(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) searchThreads = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--move-ms") == 0 && i+1 < argc) moveTimeMs = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--book") == 0 && i+1 < argc) {
+            const char* path = argv[++i];
+            if (!openingBook.load(path)) fprintf(stderr, "could not load book %s\n", path);
+        }
+    }
+    runBenchmark(moveTimeMs);
+    return 0;
+}
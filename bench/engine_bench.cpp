@@ -0,0 +1,240 @@
+// File: bench/engine_bench.cpp
+// Micro and macro benchmarks of the engine with machine-readable output, for
+// tracking performance across commits (bench/bench.cpp is the readable report
+// with its correctness checks):
+//   tictactoe-engine-bench --benchmark_format=json --benchmark_context=commit=$(git rev-parse --short HEAD)
+// g++ -O2 -I. bench/engine_bench.cpp -o tictactoe-engine-bench -pthread
+// Also takes --tt-mb 64 and --threads 4. Every search starts from an empty transposition table,
+// and the time spent clearing it is not counted.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "engine/engine.h"
+#include "bench/harness.h"
+
+using namespace std;
+
+// ---------- Positions ----------
+struct BenchBoard {
+    const char* name;
+    int rows, cols, k;
+    vector<int> moves;   // cells played alternately from X
+};
+
+Position positionOf(const BenchBoard &b) {
+    Position pos;
+    pos.reset(b.rows, b.cols, b.k);
+    for (size_t m=0;m<b.moves.size();m++) pos.makeMove(b.moves[m], m%2 == 0 ? 1 : 2);
+    return pos;
+}
+
+const vector<BenchBoard> BOARDS = {
+    {"3x3",     3,  3,  3, {4, 0, 8}},
+    {"4x4",     4,  4,  4, {0, 5, 15, 10, 3}},
+    {"8x8",     8,  8,  8, {27, 28, 36, 35, 18, 45}},
+    {"15x15k5", 15, 15, 5, {112, 113, 128, 96, 126, 98, 140}},
+};
+
+// ---------- Rules ----------
+// hasWon and isFull are what the GUI's checkWinFor and isDraw became
+void addRuleBenchmarks() {
+    for (const BenchBoard &b : BOARDS) {
+        const string shape = b.name;
+        benchmarks.add("Position/hasWon/" + shape, [b](BenchState &state) {
+            Position pos = positionOf(b);
+            while (state.keepRunning()) {
+                benchKeep(pos);
+                benchKeep(pos.hasWon(1) || pos.hasWon(2));
+            }
+        });
+        benchmarks.add("Position/isFull/" + shape, [b](BenchState &state) {
+            Position pos = positionOf(b);
+            while (state.keepRunning()) {
+                benchKeep(pos);
+                benchKeep(pos.isFull());
+            }
+        });
+        // A move and its undo, over every empty cell in turn
+        benchmarks.add("Position/makeUnmake/" + shape, [b](BenchState &state) {
+            Position pos = positionOf(b);
+            int free[MAX_CELLS], count = 0;
+            for (Mask m = pos.emptyCells(); m; m.clearLowest()) free[count++] = lowestBit(m);
+            int i = 0;
+            while (state.keepRunning()) {
+                benchKeep(pos.makeMove(free[i], 2));
+                pos.unmakeMove(free[i], 2);
+                if (++i == count) i = 0;
+            }
+        });
+        benchmarks.add("Position/winningCells/" + shape, [b](BenchState &state) {
+            Position pos = positionOf(b);
+            while (state.keepRunning()) {
+                benchKeep(pos);
+                benchKeep(pos.winningCells(1));
+            }
+        });
+        benchmarks.add("Position/distinctMoves/" + shape, [b](BenchState &state) {
+            Position pos = positionOf(b);
+            while (state.keepRunning()) {
+                benchKeep(pos);
+                benchKeep(pos.distinctMoves());
+            }
+        });
+    }
+    benchmarks.add("Position/reset/15x15k5", [](BenchState &state) {
+        Position pos;
+        while (state.keepRunning()) {
+            pos.reset(15, 15, 5);
+            pos.makeMove(112, 1);
+            benchKeep(pos);
+        }
+    });
+    benchmarks.add("FixedPosition/makeUnmake/4x4", [](BenchState &state) {
+        FixedPosition<4> pos(positionOf(BOARDS[1]));
+        int free[16], count = 0;
+        for (Mask64 m = pos.emptyCells(); m; m.clearLowest()) free[count++] = lowestBit(m);
+        int i = 0;
+        while (state.keepRunning()) {
+            benchKeep(pos.makeMove(free[i], 2));
+            pos.unmakeMove(free[i], 2);
+            if (++i == count) i = 0;
+        }
+    });
+}
+
+// ---------- Search ----------
+// minimaxAB from a fixed position with O to move, to a fixed depth
+template <class S, class Board>
+void runMinimax(BenchState &state, const Board &board, int depth) {
+    long long nodes = 0;
+    while (state.keepRunning()) {
+        state.pause();
+        transTable.clear();
+        S s(board);
+        s.maxDepth = depth;
+        state.resume();
+        benchKeep(s.minimaxAB(true, 0, numeric_limits<int>::min(), numeric_limits<int>::max()));
+        nodes = s.nodes;
+    }
+    state.counter("nodes", (double)nodes);
+    state.setItemsProcessed(nodes * state.iterations());
+}
+
+void addSearchBenchmarks() {
+    struct MinimaxCase { const char* name; BenchBoard board; int depth; };
+    const vector<MinimaxCase> cases = {
+        {"3x3/1-ply",      {"", 3,  3,  3, {0}},                                MAX_CELLS},
+        {"4x4/5-plies",    {"", 4,  4,  4, {0, 5, 15, 10, 3}},                  MAX_CELLS},
+        {"5x5/7-plies",    {"", 5,  5,  5, {12, 0, 6, 18, 4, 20, 8}},           6},
+        {"15x15k5/5-plies",{"", 15, 15, 5, {112, 113, 128, 96, 126}},           3},
+    };
+    for (const MinimaxCase &c : cases) {
+        const int depth = c.depth;
+        const Position pos = positionOf(c.board);
+        benchmarks.add(string("minimaxAB/") + c.name, [pos, depth](BenchState &state) {
+            runMinimax<Searcher>(state, pos, depth);
+        });
+    }
+    {
+        const Position pos = positionOf(cases[1].board);
+        benchmarks.add("minimaxAB/fixed/4x4/5-plies", [pos](BenchState &state) {
+            runMinimax<FixedSearcher<4>>(state, FixedPosition<4>(pos), MAX_CELLS);
+        });
+    }
+
+    // The computer's whole move from an empty board, as the game asks for it:
+    // serially and on --threads threads (default: all hardware threads)
+    vector<int> threadCounts = {1};
+    if (searchThreads > 1) threadCounts.push_back(searchThreads);
+    for (int n : {3, 4}) {
+        for (int threads : threadCounts) {
+            const string name = "findBestMove/" + to_string(n) + "x" + to_string(n) + "/empty/threads:" + to_string(threads);
+            benchmarks.add(name, [n, threads](BenchState &state) {
+                Position pos;
+                pos.reset(n);
+                const int saved = searchThreads;
+                searchThreads = threads;
+                long long nodes = 0;
+                while (state.keepRunning()) {
+                    state.pause();
+                    transTable.clear();
+                    state.resume();
+                    SearchResult r = searchPosition(pos);
+                    benchKeep(r.cell);
+                    nodes = r.nodes;
+                }
+                searchThreads = saved;
+                state.counter("nodes", (double)nodes);
+            });
+        }
+    }
+}
+
+// ---------- MCTS ----------
+// A fixed number of playouts from the same mid-game position, on a fresh tree
+void addMctsBenchmarks() {
+    const int PLAYOUTS = 20000;
+    for (int n : {6, 8, 10}) {
+        benchmarks.add("MctsSearcher/" + to_string(n) + "x" + to_string(n) + "/playouts:" + to_string(PLAYOUTS),
+                       [n, PLAYOUTS](BenchState &state) {
+            Position pos;
+            pos.reset(n);
+            pos.makeMove((n/2)*n + n/2, 1);
+            MctsSearcher mcts;
+            SearchControl control;
+            control.nodeLimit = PLAYOUTS;
+            while (state.keepRunning()) {
+                state.pause();
+                mcts.clear();
+                control.start();
+                state.resume();
+                benchKeep(mcts.search(pos, &control, 1).cell);
+            }
+            state.setItemsProcessed((long long)PLAYOUTS * state.iterations());
+        });
+    }
+}
+
+// ---------- Batch evaluation ----------
+void addEvalBenchmarks() {
+    const int COUNT = 4096;
+    for (EvalKernel kernel : {EVAL_SCALAR, EVAL_SSE41, EVAL_AVX2}) {
+        if (!evalKernelSupported(kernel)) continue;
+        benchmarks.add(string("BatchEvaluator/") + EVAL_KERNEL_NAMES[kernel] + "/8x8k5", [kernel, COUNT](BenchState &state) {
+            vector<unsigned long long> x(COUNT), o(COUNT);
+            vector<signed char> result(COUNT);
+            vector<int> heuristic(COUNT);
+            srand(777);
+            for (int i=0;i<COUNT;i++) {
+                for (int c=0;c<64;c++) {
+                    int r = rand() % 3;
+                    if (r == 1) x[i] |= 1ULL << c;
+                    else if (r == 2) o[i] |= 1ULL << c;
+                }
+            }
+            BatchEvaluator eval(8, 8, 5);
+            while (state.keepRunning()) {
+                eval.evaluate(x.data(), o.data(), COUNT, result.data(), heuristic.data(), kernel);
+                benchKeep(result[0]);
+            }
+            state.setItemsProcessed((long long)COUNT * state.iterations());
+        });
+    }
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    for (int i=1;i<argc;i++) {
+        if (strcmp(argv[i], "--tt-mb") == 0 && i+1 < argc) transTable.resize(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && i+1 < argc) searchThreads = max(1, atoi(argv[++i]));
+    }
+    addRuleBenchmarks();
+    addSearchBenchmarks();
+    addMctsBenchmarks();
+    addEvalBenchmarks();
+    return benchmarks.runMain(argc, argv);
+}
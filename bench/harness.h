@@ -0,0 +1,286 @@
+// File: bench/harness.h
+// A small benchmark runner in the manner of Google Benchmark, so results can
+// be tracked from commit to commit with the same tools (compare.py reads the
+// JSON): each benchmark body loops until it has run for --benchmark_min_time,
+// and the report is a console table, CSV or Google Benchmark's JSON layout.
+//   benchmarks.add("Position/isFull/3x3", [&](BenchState &state) {
+//       while (state.keepRunning()) benchKeep(pos.isFull());
+//   });
+//   return benchmarks.runMain(argc, argv);
+// Options: --benchmark_filter=<regex>  --benchmark_min_time=<sec>
+//          --benchmark_format=console|json|csv  --benchmark_out=<file>
+//          --benchmark_out_format=console|json|csv  --benchmark_context=<key>=<value>
+//          --benchmark_list_tests
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <functional>
+#include <regex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// ---------- Loop state ----------
+// Keeps the compiler from dropping a result or hoisting work out of the loop:
+// value is taken to be read, and all memory (value included) to be written
+template <class T>
+inline void benchKeep(const T &value) { asm volatile("" : : "r"(&value) : "memory"); }
+
+class BenchState {
+private:
+    long long target, done = 0;
+    bool paused = true;
+    chrono::steady_clock::time_point wallStart;
+    clock_t cpuStart = 0;
+    double wall = 0, cpu = 0;
+    long long items = 0;
+    vector<pair<string, double>> counters;
+
+    friend class BenchRegistry;
+
+public:
+    explicit BenchState(long long iterations) : target(iterations) {}
+
+    // while (state.keepRunning()) { ...one iteration... }
+    bool keepRunning() {
+        if (done == 0) resume();
+        if (done < target) { done++; return true; }
+        pause();
+        return false;
+    }
+
+    // Leave setup out of the measured time, e.g. clearing the transposition table
+    void pause() {
+        if (paused) return;
+        wall += chrono::duration<double>(chrono::steady_clock::now() - wallStart).count();
+        cpu += (double)(clock() - cpuStart) / CLOCKS_PER_SEC;
+        paused = true;
+    }
+    void resume() {
+        if (!paused) return;
+        wallStart = chrono::steady_clock::now();
+        cpuStart = clock();
+        paused = false;
+    }
+
+    long long iterations() const { return target; }
+    // Work done over the whole run, reported as items_per_second
+    void setItemsProcessed(long long n) { items = n; }
+    // Reported as is, next to the times
+    void counter(const string &name, double value) { counters.push_back({name, value}); }
+};
+
+// ---------- Runner ----------
+struct BenchRun {
+    string name;
+    long long iterations;
+    double realTime, cpuTime;   // per iteration, in unit
+    const char* unit;
+    double itemsPerSecond;      // 0 = not reported
+    vector<pair<string, double>> counters;
+};
+
+class BenchRegistry {
+private:
+    struct Entry { string name; function<void(BenchState&)> body; };
+    vector<Entry> entries;
+
+    static const long long MAX_ITERATIONS = 1000000000;
+
+    // Iterations grow until one run lasts minTime, as Google Benchmark does
+    static BenchRun measure(const Entry &e, double minTime) {
+        long long n = 1;
+        for (;;) {
+            BenchState state(n);
+            e.body(state);
+            state.pause();
+            const double wall = state.wall;
+            if (wall >= minTime || n >= MAX_ITERATIONS) {
+                BenchRun r;
+                r.name = e.name;
+                r.iterations = n;
+                const double perIter = wall / n;
+                const double scale = perIter < 1e-5 ? 1e9 : perIter < 1e-2 ? 1e6 : 1e3;
+                r.unit = scale == 1e9 ? "ns" : scale == 1e6 ? "us" : "ms";
+                r.realTime = perIter * scale;
+                r.cpuTime = state.cpu / n * scale;
+                r.itemsPerSecond = state.items && wall > 0 ? state.items / wall : 0;
+                r.counters = state.counters;
+                return r;
+            }
+            double grow = wall > 0 ? minTime * 1.4 / wall : 10;
+            n = min(MAX_ITERATIONS, max(n + 1, (long long)(n * min(grow, 10.0))));
+        }
+    }
+
+    static string jsonEscape(const string &s) {
+        string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static void writeConsoleHeader(FILE* f, int width) {
+        fprintf(f, "%-*s %15s %15s %12s\n", width, "Benchmark", "Time", "CPU", "Iterations");
+        fprintf(f, "%s\n", string(width + 45, '-').c_str());
+    }
+
+    static void writeConsoleRow(FILE* f, int width, const BenchRun &r) {
+        fprintf(f, "%-*s %12.1f %-2s %12.1f %-2s %12lld", width, r.name.c_str(),
+                r.realTime, r.unit, r.cpuTime, r.unit, r.iterations);
+        if (r.itemsPerSecond > 0) fprintf(f, " items_per_second=%.4g/s", r.itemsPerSecond);
+        for (auto &c : r.counters) fprintf(f, " %s=%.4g", c.first.c_str(), c.second);
+        fprintf(f, "\n");
+    }
+
+    static int nameWidth(const vector<BenchRun> &runs) {
+        size_t width = 9;
+        for (const BenchRun &r : runs) width = max(width, r.name.size());
+        return (int)width;
+    }
+
+    static void writeConsole(FILE* f, const vector<BenchRun> &runs) {
+        const int width = nameWidth(runs);
+        writeConsoleHeader(f, width);
+        for (const BenchRun &r : runs) writeConsoleRow(f, width, r);
+    }
+
+    static void writeCsv(FILE* f, const vector<BenchRun> &runs) {
+        vector<string> names;   // every counter that appears, one column each
+        for (const BenchRun &r : runs)
+            for (auto &c : r.counters)
+                if (find(names.begin(), names.end(), c.first) == names.end()) names.push_back(c.first);
+        fprintf(f, "name,iterations,real_time,cpu_time,time_unit,items_per_second");
+        for (const string &n : names) fprintf(f, ",\"%s\"", n.c_str());
+        fprintf(f, "\n");
+        for (const BenchRun &r : runs) {
+            fprintf(f, "\"%s\",%lld,%.6g,%.6g,%s,", r.name.c_str(), r.iterations, r.realTime, r.cpuTime, r.unit);
+            if (r.itemsPerSecond > 0) fprintf(f, "%.6g", r.itemsPerSecond);
+            for (const string &n : names) {
+                fprintf(f, ",");
+                for (auto &c : r.counters) if (c.first == n) { fprintf(f, "%.6g", c.second); break; }
+            }
+            fprintf(f, "\n");
+        }
+    }
+
+    static void writeJson(FILE* f, const vector<BenchRun> &runs, const char* executable,
+                          const vector<pair<string, string>> &context) {
+        char date[64];
+        time_t now = time(nullptr);
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+        fprintf(f, "{\n  \"context\": {\n");
+        fprintf(f, "    \"date\": \"%s\",\n", date);
+        fprintf(f, "    \"executable\": \"%s\",\n", jsonEscape(executable).c_str());
+        fprintf(f, "    \"num_cpus\": %u,\n", thread::hardware_concurrency());
+#ifdef NDEBUG
+        fprintf(f, "    \"library_build_type\": \"release\"");
+#else
+        fprintf(f, "    \"library_build_type\": \"debug\"");
+#endif
+        for (auto &c : context)
+            fprintf(f, ",\n    \"%s\": \"%s\"", jsonEscape(c.first).c_str(), jsonEscape(c.second).c_str());
+        fprintf(f, "\n  },\n  \"benchmarks\": [");
+        for (size_t i=0;i<runs.size();i++) {
+            const BenchRun &r = runs[i];
+            fprintf(f, "%s\n    {\n", i ? "," : "");
+            fprintf(f, "      \"name\": \"%s\",\n", jsonEscape(r.name).c_str());
+            fprintf(f, "      \"run_name\": \"%s\",\n", jsonEscape(r.name).c_str());
+            fprintf(f, "      \"run_type\": \"iteration\",\n");
+            fprintf(f, "      \"iterations\": %lld,\n", r.iterations);
+            fprintf(f, "      \"real_time\": %.6g,\n", r.realTime);
+            fprintf(f, "      \"cpu_time\": %.6g,\n", r.cpuTime);
+            fprintf(f, "      \"time_unit\": \"%s\"", r.unit);
+            if (r.itemsPerSecond > 0) fprintf(f, ",\n      \"items_per_second\": %.6g", r.itemsPerSecond);
+            for (auto &c : r.counters) fprintf(f, ",\n      \"%s\": %.6g", jsonEscape(c.first).c_str(), c.second);
+            fprintf(f, "\n    }");
+        }
+        fprintf(f, "\n  ]\n}\n");
+    }
+
+    static bool write(FILE* f, const string &format, const vector<BenchRun> &runs, const char* executable,
+                      const vector<pair<string, string>> &context) {
+        if (format == "console") writeConsole(f, runs);
+        else if (format == "json") writeJson(f, runs, executable, context);
+        else if (format == "csv") writeCsv(f, runs);
+        else return false;
+        return true;
+    }
+
+    // "--benchmark_x=value" -> value when arg names option x
+    static const char* optionValue(const char* arg, const char* option) {
+        size_t n = strlen(option);
+        return strncmp(arg, option, n) == 0 && arg[n] == '=' ? arg + n + 1 : nullptr;
+    }
+
+public:
+    void add(const string &name, function<void(BenchState&)> body) { entries.push_back({name, move(body)}); }
+
+    // Runs the benchmarks the options select; arguments that are not
+    // --benchmark_ options are left to the program
+    int runMain(int argc, char** argv) {
+        string filter = ".", format = "console", outPath, outFormat = "json";
+        double minTime = 0.5;
+        bool list = false;
+        vector<pair<string, string>> context;
+        for (int i=1;i<argc;i++) {
+            const char* a = argv[i];
+            const char* v;
+            if (strncmp(a, "--benchmark_", 12) != 0) continue;
+            if ((v = optionValue(a, "--benchmark_filter"))) filter = v;
+            else if ((v = optionValue(a, "--benchmark_format"))) format = v;
+            else if ((v = optionValue(a, "--benchmark_out"))) outPath = v;
+            else if ((v = optionValue(a, "--benchmark_out_format"))) outFormat = v;
+            else if ((v = optionValue(a, "--benchmark_min_time"))) minTime = max(1e-3, atof(v));   // "0.5" or "0.5s"
+            else if ((v = optionValue(a, "--benchmark_context"))) {
+                const char* eq = strchr(v, '=');
+                if (!eq) { fprintf(stderr, "--benchmark_context wants key=value\n"); return 1; }
+                context.push_back({string(v, eq - v), string(eq + 1)});
+            }
+            else if (strcmp(a, "--benchmark_list_tests") == 0 || strcmp(a, "--benchmark_list_tests=true") == 0) list = true;
+            else { fprintf(stderr, "unknown option %s\n", a); return 1; }
+        }
+        regex pattern;
+        try { pattern = regex(filter); }
+        catch (const regex_error&) { fprintf(stderr, "bad --benchmark_filter %s\n", filter.c_str()); return 1; }
+
+        vector<const Entry*> selected;
+        size_t width = 9;
+        for (const Entry &e : entries)
+            if (regex_search(e.name, pattern)) { selected.push_back(&e); width = max(width, e.name.size()); }
+        if (list) {
+            for (const Entry* e : selected) printf("%s\n", e->name.c_str());
+            return 0;
+        }
+
+        vector<BenchRun> runs;
+        if (format == "console") writeConsoleHeader(stdout, (int)width);
+        for (const Entry* e : selected) {
+            runs.push_back(measure(*e, minTime));
+            if (format == "console") { writeConsoleRow(stdout, (int)width, runs.back()); fflush(stdout); }   // progress as it goes
+        }
+        if (format != "console" && !write(stdout, format, runs, argv[0], context)) {
+            fprintf(stderr, "unknown --benchmark_format %s\n", format.c_str());
+            return 1;
+        }
+        if (!outPath.empty()) {
+            FILE* f = fopen(outPath.c_str(), "w");
+            if (!f) { fprintf(stderr, "could not write %s\n", outPath.c_str()); return 1; }
+            bool ok = write(f, outFormat, runs, argv[0], context);
+            fclose(f);
+            if (!ok) { fprintf(stderr, "unknown --benchmark_out_format %s\n", outFormat.c_str()); return 1; }
+        }
+        return 0;
+    }
+};
+inline BenchRegistry benchmarks;
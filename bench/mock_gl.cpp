@@ -0,0 +1,93 @@
+// File: bench/mock_gl.cpp
+// The GL, GLU and GLUT entry points tictactoe.cpp uses, as counting no-ops.
+// glutGetProcAddress hands out buffer-object functions too, so the game takes
+// the same path as on a GL 1.5 driver. Definitions follow the system headers;
+// a signature that drifts from them fails to compile.
+
+#include <GL/freeglut.h>
+#include <GL/glext.h>
+#include <cstring>
+
+#include "bench/mock_gl.h"
+
+MockGlCounters mockGl = {};
+
+// ---------- GL ----------
+void APIENTRY glClear(GLbitfield) { mockGl.calls++; }
+void APIENTRY glClearColor(GLclampf, GLclampf, GLclampf, GLclampf) { mockGl.calls++; }
+void APIENTRY glColor3f(GLfloat, GLfloat, GLfloat) { mockGl.calls++; }
+void APIENTRY glEnable(GLenum) { mockGl.calls++; }
+void APIENTRY glDisable(GLenum) { mockGl.calls++; }
+void APIENTRY glAlphaFunc(GLenum, GLclampf) { mockGl.calls++; }
+void APIENTRY glLineWidth(GLfloat) { mockGl.calls++; }
+void APIENTRY glViewport(GLint, GLint, GLsizei, GLsizei) { mockGl.calls++; }
+void APIENTRY glMatrixMode(GLenum) { mockGl.calls++; }
+void APIENTRY glLoadIdentity() { mockGl.calls++; }
+void APIENTRY glRasterPos2i(GLint, GLint) { mockGl.calls++; }
+void APIENTRY glRasterPos2f(GLfloat, GLfloat) { mockGl.calls++; }
+void APIENTRY glPixelStorei(GLenum, GLint) { mockGl.calls++; }
+void APIENTRY glReadPixels(GLint, GLint, GLsizei, GLsizei, GLenum, GLenum, GLvoid*) { mockGl.calls++; }
+void APIENTRY glEnableClientState(GLenum) { mockGl.calls++; }
+void APIENTRY glDisableClientState(GLenum) { mockGl.calls++; }
+void APIENTRY glVertexPointer(GLint, GLenum, GLsizei, const GLvoid*) { mockGl.calls++; }
+void APIENTRY glColorPointer(GLint, GLenum, GLsizei, const GLvoid*) { mockGl.calls++; }
+void APIENTRY glTexCoordPointer(GLint, GLenum, GLsizei, const GLvoid*) { mockGl.calls++; }
+void APIENTRY glDrawArrays(GLenum, GLint, GLsizei count) {
+    mockGl.calls++;
+    mockGl.drawCalls++;
+    mockGl.vertices += count;
+}
+void APIENTRY glGenTextures(GLsizei n, GLuint* textures) {
+    mockGl.calls++;
+    for (GLsizei i=0;i<n;i++) textures[i] = 1;
+}
+void APIENTRY glBindTexture(GLenum, GLuint) { mockGl.calls++; }
+void APIENTRY glTexParameteri(GLenum, GLenum, GLint) { mockGl.calls++; }
+void APIENTRY glTexEnvi(GLenum, GLenum, GLint) { mockGl.calls++; }
+void APIENTRY glTexImage2D(GLenum, GLint, GLint, GLsizei width, GLsizei height, GLint, GLenum, GLenum, const GLvoid*) {
+    mockGl.calls++;
+    mockGl.uploadBytes += (long long)width * height;
+}
+
+// Buffer objects, reached through glutGetProcAddress
+static GLuint nextBuffer = 1;
+static void APIENTRY mockGenBuffers(GLsizei n, GLuint* buffers) {
+    mockGl.calls++;
+    for (GLsizei i=0;i<n;i++) buffers[i] = nextBuffer++;
+}
+static void APIENTRY mockDeleteBuffers(GLsizei, const GLuint*) { mockGl.calls++; }
+static void APIENTRY mockBindBuffer(GLenum, GLuint) { mockGl.calls++; }
+static void APIENTRY mockBufferData(GLenum, GLsizeiptr size, const void*, GLenum) {
+    mockGl.calls++;
+    mockGl.uploadBytes += size;
+}
+
+// ---------- GLU ----------
+void GLAPIENTRY gluOrtho2D(GLdouble, GLdouble, GLdouble, GLdouble) { mockGl.calls++; }
+
+// ---------- GLUT ----------
+void* glutBitmapHelvetica18 = nullptr;
+
+void FGAPIENTRY glutInit(int*, char**) { mockGl.calls++; }
+void FGAPIENTRY glutInitDisplayMode(unsigned int) { mockGl.calls++; }
+void FGAPIENTRY glutInitWindowSize(int, int) { mockGl.calls++; }
+int FGAPIENTRY glutCreateWindow(const char*) { mockGl.calls++; return 1; }
+void FGAPIENTRY glutDisplayFunc(void (*)(void)) { mockGl.calls++; }
+void FGAPIENTRY glutReshapeFunc(void (*)(int, int)) { mockGl.calls++; }
+void FGAPIENTRY glutMouseFunc(void (*)(int, int, int, int)) { mockGl.calls++; }
+void FGAPIENTRY glutCloseFunc(void (*)(void)) { mockGl.calls++; }
+void FGAPIENTRY glutTimerFunc(unsigned int, void (*)(int), int) { mockGl.calls++; }
+void FGAPIENTRY glutMainLoop() { mockGl.calls++; }
+void FGAPIENTRY glutPostRedisplay() { mockGl.calls++; }
+void FGAPIENTRY glutSwapBuffers() { mockGl.calls++; }
+void FGAPIENTRY glutBitmapCharacter(void*, int) { mockGl.calls++; }
+int FGAPIENTRY glutBitmapWidth(void*, int) { mockGl.calls++; return 10; }
+
+GLUTproc FGAPIENTRY glutGetProcAddress(const char* name) {
+    mockGl.calls++;
+    if (strcmp(name, "glGenBuffers") == 0) return (GLUTproc)mockGenBuffers;
+    if (strcmp(name, "glDeleteBuffers") == 0) return (GLUTproc)mockDeleteBuffers;
+    if (strcmp(name, "glBindBuffer") == 0) return (GLUTproc)mockBindBuffer;
+    if (strcmp(name, "glBufferData") == 0) return (GLUTproc)mockBufferData;
+    return nullptr;   // no swap control
+}
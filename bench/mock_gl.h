@@ -0,0 +1,13 @@
+// File: bench/mock_gl.h
+// Counters kept by bench/mock_gl.cpp, a stand-in for OpenGL, GLU and GLUT that
+// draws nothing: linking the GUI against it measures the CPU side of a frame
+// (layout, batching, uploads) on machines without a display.
+#pragma once
+
+struct MockGlCounters {
+    long long calls;         // every gl*, glu* and glut* call
+    long long drawCalls;     // glDrawArrays
+    long long vertices;      // vertices passed to glDrawArrays
+    long long uploadBytes;   // glBufferData and glTexImage2D
+};
+extern MockGlCounters mockGl;
@@ -0,0 +1,117 @@
+// File: bench/render_bench.cpp
+// Frame cost of the GUI without a display: tictactoe.cpp linked against the
+// counting no-op GL of bench/mock_gl.cpp. It times the CPU work of a frame and
+// reports the GL calls, draws, vertices and bytes uploaded per frame; the GPU's
+// share is not measured. Same options and output as tictactoe-engine-bench:
+//   tictactoe-render-bench --benchmark_format=json
+// g++ -O2 -I. bench/render_bench.cpp bench/mock_gl.cpp -o tictactoe-render-bench -pthread
+
+#define main tictactoeMain
+#include "tictactoe.cpp"
+#undef main
+
+#include "bench/harness.h"
+#include "bench/mock_gl.h"
+
+// ---------- Scenes ----------
+// Plays cell on the current game the way a click would
+void clickCell(int cell) {
+    float sx, sy, cs;
+    computeBoardViewport(sx, sy, cs);
+    const int n = game->getN();
+    game->placeAtWindowCoord((int)(sx + (cell % n + 0.5f) * cs), (int)(sy + (cell / n + 0.5f) * cs), sx, sy, cs);
+}
+
+// A two-player game on an n x n board, k in a row, some way in
+void startGame(int n, int k) {
+    appState = STATE_PLAY;
+    selectedMode = HUMAN_VS_HUMAN;
+    game = &gameSlot;
+    game->start(n, k);
+    const int cells[] = {0, n + 1, 2*n + 2, n*n - 1, n - 1, n*(n - 1), n/2};
+    for (int cell : cells) clickCell(cell);
+}
+
+// Draws frames until every mark has finished growing
+void settle() {
+    for (int i=0;i<3;i++) {
+        displayRouter();
+        this_thread::sleep_for(chrono::milliseconds(300));
+    }
+    displayRouter();
+}
+
+// Per-frame GL traffic over the run
+void reportGl(BenchState &state, const MockGlCounters &before) {
+    const double frames = (double)state.iterations();
+    state.counter("gl_calls", (mockGl.calls - before.calls) / frames);
+    state.counter("draw_calls", (mockGl.drawCalls - before.drawCalls) / frames);
+    state.counter("vertices", (mockGl.vertices - before.vertices) / frames);
+    state.counter("upload_bytes", (mockGl.uploadBytes - before.uploadBytes) / frames);
+}
+
+void addFrameBenchmarks() {
+    for (MenuStep step : {MODE_SELECT, SIZE_SELECT}) {
+        benchmarks.add(step == MODE_SELECT ? "frame/menu/mode" : "frame/menu/size", [step](BenchState &state) {
+            game = nullptr;
+            appState = STATE_MENU;
+            menuStep = step;
+            displayRouter();
+            const MockGlCounters before = mockGl;
+            while (state.keepRunning()) displayRouter();
+            reportGl(state, before);
+        });
+    }
+
+    struct Board { int n, k; };
+    for (Board b : {Board{3, 3}, Board{10, 10}, Board{GOMOKU_N, GOMOKU_K}}) {
+        const string shape = to_string(b.n) + "x" + to_string(b.n);
+        // A redraw with nothing changed, e.g. after an expose
+        benchmarks.add("frame/game/" + shape + "/idle", [b](BenchState &state) {
+            startGame(b.n, b.k);
+            settle();
+            const MockGlCounters before = mockGl;
+            while (state.keepRunning()) displayRouter();
+            reportGl(state, before);
+        });
+        // The frame right after a move: the marks are rebuilt and one is animating
+        benchmarks.add("frame/game/" + shape + "/after-move", [b](BenchState &state) {
+            startGame(b.n, b.k);
+            game->manualRestart();
+            int cell = 0;
+            const MockGlCounters before = mockGl;
+            while (state.keepRunning()) {
+                state.pause();
+                if (game->isGameOver() || cell == b.n*b.n) { game->manualRestart(); cell = 0; }
+                clickCell(cell++);
+                state.resume();
+                displayRouter();
+            }
+            reportGl(state, before);
+        });
+    }
+
+    // Resizing the window: buttons laid out again and the grid rebuilt
+    benchmarks.add("frame/game/10x10/resize", [](BenchState &state) {
+        startGame(10, 10);
+        settle();
+        bool wide = false;
+        const MockGlCounters before = mockGl;
+        while (state.keepRunning()) {
+            wide = !wide;
+            reshape(wide ? 800 : 700, 700);
+            displayRouter();
+        }
+        reshape(700, 700);
+        reportGl(state, before);
+    });
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    loadBufferFunctions();
+    reshape(WIN_W, WIN_H);
+    displayRouter();   // builds the glyph atlas
+    addFrameBenchmarks();
+    return benchmarks.runMain(argc, argv);
+}
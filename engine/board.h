@@ -0,0 +1,442 @@
+// File: engine/board.h
+// Board representation and rules: bitboards, win lines, scores, Zobrist keys,
+// the incremental Position and the Game that referees one match. No GL.
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+
+using namespace std;
+
+// ---------- Bitboard tables ----------
+// Cell (i,j) of a rows x cols board is bit i*cols + j of a Mask; MASK_WORDS
+// 64-bit words cover the largest board. A player wins with k marks in a row:
+// every length-k window along a row, column or diagonal is a line. The line
+// masks for a shape are built once and shared by every game.
+const int MAX_N = 15;                  // longest side (Gomoku is 15 x 15, k = 5)
+const int MAX_CELLS = MAX_N*MAX_N;
+const int MAX_LINES = 4*MAX_CELLS;     // at most one window per cell and direction
+const int MASK_WORDS = (MAX_CELLS + 63) / 64;
+const int NUM_SYMS = 8;   // rotations and reflections of the square (D4)
+const int NEAR_RADIUS = 2;   // candidate moves on large boards: this close to a stone
+
+template <int WORDS>
+struct BasicMask {
+    unsigned long long w[WORDS];
+
+    BasicMask() : w() {}
+
+    static BasicMask bit(int cell) {
+        BasicMask m;
+        m.w[cell >> 6] = 1ULL << (cell & 63);
+        return m;
+    }
+
+    BasicMask operator&(const BasicMask &o) const { BasicMask m; for (int i=0;i<WORDS;i++) m.w[i] = w[i] & o.w[i]; return m; }
+    BasicMask operator|(const BasicMask &o) const { BasicMask m; for (int i=0;i<WORDS;i++) m.w[i] = w[i] | o.w[i]; return m; }
+    BasicMask operator~() const { BasicMask m; for (int i=0;i<WORDS;i++) m.w[i] = ~w[i]; return m; }
+    BasicMask& operator&=(const BasicMask &o) { for (int i=0;i<WORDS;i++) w[i] &= o.w[i]; return *this; }
+    BasicMask& operator|=(const BasicMask &o) { for (int i=0;i<WORDS;i++) w[i] |= o.w[i]; return *this; }
+    bool operator==(const BasicMask &o) const { for (int i=0;i<WORDS;i++) if (w[i] != o.w[i]) return false; return true; }
+    bool operator!=(const BasicMask &o) const { return !(*this == o); }
+    explicit operator bool() const { for (int i=0;i<WORDS;i++) if (w[i]) return true; return false; }
+
+    // Index of the lowest set bit; the mask must not be empty
+    int lowest() const {
+        for (int i=0;;i++) if (w[i]) return i*64 + __builtin_ctzll(w[i]);
+    }
+    void clearLowest() {
+        for (int i=0;i<WORDS;i++) if (w[i]) { w[i] &= w[i] - 1; return; }
+    }
+    int count() const {
+        int c = 0;
+        for (int i=0;i<WORDS;i++) c += __builtin_popcountll(w[i]);
+        return c;
+    }
+};
+
+// A board of up to 64 cells fits one word: the fixed-size engines use that
+using Mask = BasicMask<MASK_WORDS>;
+using Mask64 = BasicMask<1>;
+
+struct WinTable {
+    int rows, cols, k, cells;
+    Mask full;                         // every cell of the board
+    vector<Mask> lines;                // every k-cell window along the 4 directions
+    vector<vector<int>> linesThrough;  // per cell: indices of the lines containing it
+    int sym[NUM_SYMS][MAX_CELLS];      // cell -> cell under each symmetry (sym[0] is identity)
+    int symInv[NUM_SYMS][MAX_CELLS];   // inverse of sym[s]
+    int cellWeight[MAX_CELLS];         // lines through the cell: centre and corners score highest
+    // Lines shorter than the board (Gomoku): only cells near a stone are searched
+    bool nearOnly;
+    vector<vector<int>> neighbours;    // per cell: other cells within NEAR_RADIUS
+    int centre;                        // the opening move when nearOnly
+};
+
+inline unique_ptr<WinTable> buildWinTable(int rows, int cols, int k) {
+    unique_ptr<WinTable> t(new WinTable());
+    t->rows = rows; t->cols = cols; t->k = k; t->cells = rows*cols;
+    for (int c=0;c<t->cells;c++) t->full |= Mask::bit(c);
+    // windows starting at (i,j) going right, down, down-right and down-left
+    const int dirs[4][2] = {{0,1}, {1,0}, {1,1}, {1,-1}};
+    for (int d=0;d<4;d++)
+        for (int i=0;i<rows;i++)
+            for (int j=0;j<cols;j++){
+                int ei = i + dirs[d][0]*(k-1), ej = j + dirs[d][1]*(k-1);
+                if (ei < 0 || ei >= rows || ej < 0 || ej >= cols) continue;
+                Mask line;
+                for (int s=0;s<k;s++) line |= Mask::bit((i + dirs[d][0]*s)*cols + j + dirs[d][1]*s);
+                t->lines.push_back(line);
+            }
+    t->linesThrough.assign(t->cells, vector<int>());
+    for (int l=0;l<(int)t->lines.size();l++)
+        for (Mask m = t->lines[l]; m; m.clearLowest())
+            t->linesThrough[m.lowest()].push_back(l);
+    for (int c=0;c<t->cells;c++) t->cellWeight[c] = (int)t->linesThrough[c].size();
+    // A rectangle keeps only identity, half turn, mirror and flip; the other
+    // four slots repeat the identity so every view stays a valid board.
+    const bool square = rows == cols;
+    for (int i=0;i<rows;i++){
+        for (int j=0;j<cols;j++){
+            const int r = rows-1-i, c = cols-1-j;
+            const int img[NUM_SYMS][2] = {
+                {i,j}, {j,r}, {r,c}, {c,i},   // rotations by 0, 90, 180, 270
+                {i,c}, {r,j}, {j,i}, {c,r}    // mirror, flip, transpose, anti-transpose
+            };
+            for (int s=0;s<NUM_SYMS;s++){
+                bool valid = square || s == 0 || s == 2 || s == 4 || s == 5;
+                int to = valid ? img[s][0]*cols + img[s][1] : i*cols + j;
+                t->sym[s][i*cols + j] = to;
+                t->symInv[s][to] = i*cols + j;
+            }
+        }
+    }
+    t->nearOnly = k < max(rows, cols);
+    t->centre = (rows/2)*cols + cols/2;
+    t->neighbours.assign(t->cells, vector<int>());
+    if (t->nearOnly)
+        for (int i=0;i<rows;i++)
+            for (int j=0;j<cols;j++)
+                for (int a=max(0, i-NEAR_RADIUS); a<=min(rows-1, i+NEAR_RADIUS); a++)
+                    for (int b=max(0, j-NEAR_RADIUS); b<=min(cols-1, j+NEAR_RADIUS); b++)
+                        if (a != i || b != j) t->neighbours[i*cols + j].push_back(a*cols + b);
+    return t;
+}
+
+// Tables are built on first use; self-play starts games on many threads at once.
+inline const WinTable& winTableFor(int rows, int cols, int k) {
+    static mutex lock;
+    static map<int, unique_ptr<WinTable>> tables;
+    lock_guard<mutex> guard(lock);
+    unique_ptr<WinTable> &t = tables[(rows*(MAX_N+1) + cols)*(MAX_N+1) + k];
+    if (!t) t = buildWinTable(rows, cols, k);
+    return *t;
+}
+
+inline const WinTable& winTableFor(int n) { return winTableFor(n, n, n); }
+
+// A board shape the engine can play: 3 <= k <= longest side <= MAX_N
+inline bool validShape(int rows, int cols, int k) {
+    return rows >= 1 && cols >= 1 && rows <= MAX_N && cols <= MAX_N && k >= 3 && k <= max(rows, cols);
+}
+
+template <int W> inline int popCount(const BasicMask<W> &m) { return m.count(); }
+template <int W> inline int lowestBit(const BasicMask<W> &m) { return m.lowest(); }
+
+// ---------- Scores ----------
+// Terminal: +WIN_SCORE - depth if O wins, -WIN_SCORE + depth if X wins, 0 draw.
+// At the depth limit a position gets a heuristic score within +-MAX_HEURISTIC:
+// each line still open to only one player counts LINE_WEIGHT[marks] for that player.
+const int WIN_SCORE = 10000;
+const int MAX_HEURISTIC = 5000;
+const int LINE_WEIGHT[MAX_N + 1] = {0, 1, 4, 16, 64, 256, 512, 1024, 1024, 1024, 1024,
+                                    1024, 1024, 1024, 1024, 1024};
+
+inline bool isWinScore(int v) { return v > WIN_SCORE - 1000 || v < -(WIN_SCORE - 1000); }
+
+inline int lineScore(int xMarks, int oMarks) {
+    if (xMarks && oMarks) return 0;
+    return oMarks ? LINE_WEIGHT[oMarks] : -LINE_WEIGHT[xMarks];
+}
+
+// ---------- Zobrist keys ----------
+// Fixed seed so keys (and therefore search results) are the same on every run.
+struct ZobristKeys {
+    unsigned long long cell[3][MAX_CELLS];   // [player][cell]
+    unsigned long long size[MAX_N + 1];      // [rows]; keeps boards of different shapes apart
+    unsigned long long toMove[3];            // [player]; the same marks can come up with either side to move
+    unsigned long long cols[MAX_N + 1];      // [cols]
+    unsigned long long inRow[MAX_N + 1];     // [k]
+    ZobristKeys() {
+        unsigned long long x = 0x9E3779B97F4A7C15ULL;
+        auto next = [&x]() {   // splitmix64
+            unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        };
+        for (int p=0;p<3;p++) for (int c=0;c<MAX_CELLS;c++) cell[p][c] = next();
+        for (int n=0;n<=MAX_N;n++) size[n] = next();
+        for (int p=0;p<3;p++) toMove[p] = next();
+        for (int n=0;n<=MAX_N;n++) cols[n] = next();
+        for (int n=0;n<=MAX_N;n++) inRow[n] = next();
+    }
+};
+inline const ZobristKeys zobrist;
+
+
+// ---------- Position ----------
+// Board state shared by the game and the search. makeMove/unmakeMove keep the
+// per-line counts, threat cells and symmetry hashes in step with the bitboards.
+// Everything is inline and sized for MAX_N, so a Position never allocates.
+struct alignas(64) Position {
+    using MaskType = Mask;
+    int rows, cols, k;
+    const WinTable* wins = nullptr;
+    Mask bb[3];                             // bb[1] = cells of X (player1), bb[2] = cells of O (player2 or computer)
+    unsigned char lineCount[3][MAX_LINES];  // marks of each player on each line
+    int completed[3];                       // full lines owned by each player
+    int emptyCount;
+    unsigned long long hashes[NUM_SYMS];    // Zobrist key of the board seen through each symmetry
+    int heuristic;                          // sum of lineScore over all lines, O's point of view
+    // Threat lines hold k-1 marks of one player and none of the other
+    unsigned char threatCount[3][MAX_CELLS];   // [player][cell] threat lines through the cell
+    Mask threats[3];                           // cells with a nonzero threatCount
+    unsigned char nearCount[MAX_CELLS];        // stones within NEAR_RADIUS (nearOnly boards)
+    Mask near;                                 // cells with a nonzero nearCount
+
+    void reset(int size) { reset(size, size, size); }
+
+    void reset(int r, int c, int inRow) {
+        rows = r; cols = c; k = inRow;
+        if (!wins || wins->rows != r || wins->cols != c || wins->k != inRow) wins = &winTableFor(r, c, inRow);
+        bb[0] = bb[1] = bb[2] = Mask();
+        // only the lines and cells of this shape are ever read
+        const size_t lineTotal = wins->lines.size();
+        for (int p=0;p<3;p++) memset(lineCount[p], 0, lineTotal);
+        completed[0] = completed[1] = completed[2] = 0;
+        emptyCount = wins->cells;
+        const unsigned long long shape = zobrist.size[rows] ^ zobrist.cols[cols] ^ zobrist.inRow[k];
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] = shape;
+        heuristic = 0;
+        for (int p=0;p<3;p++) memset(threatCount[p], 0, wins->cells);
+        threats[0] = threats[1] = threats[2] = Mask();
+        memset(nearCount, 0, wins->cells);
+        near = Mask();
+    }
+
+    Mask emptyCells() const { return wins->full & ~(bb[1] | bb[2]); }
+
+    // 0 empty, 1 = X, 2 = O
+    int cellAt(int cell) const {
+        Mask bit = Mask::bit(cell);
+        if (bb[1] & bit) return 1;
+        if (bb[2] & bit) return 2;
+        return 0;
+    }
+
+    bool isThreat(int q, int l) const { return lineCount[q][l] == k-1 && lineCount[3-q][l] == 0; }
+
+    // A line became (or stopped being) a threat for q
+    void markThreat(int q, int l, int delta) {
+        for (Mask m = wins->lines[l]; m; m.clearLowest()) {
+            int c = lowestBit(m);
+            threatCount[q][c] += delta;
+            if (threatCount[q][c]) threats[q] |= Mask::bit(c);
+            else threats[q] &= ~Mask::bit(c);
+        }
+    }
+
+    void markNear(int cell, int delta) {
+        for (int c : wins->neighbours[cell]) {
+            nearCount[c] += delta;
+            if (nearCount[c]) near |= Mask::bit(c);
+            else near &= ~Mask::bit(c);
+        }
+    }
+
+    // Only the windows through the played cell are touched, so both are
+    // independent of the board area. Returns true if this move completed a line for p.
+    bool makeMove(int cell, int p) {
+        bb[p] |= Mask::bit(cell);
+        --emptyCount;
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] ^= zobrist.cell[p][wins->sym[s][cell]];
+        bool won = false;
+        for (int l : wins->linesThrough[cell]) {
+            const bool mine = isThreat(p, l), theirs = isThreat(3-p, l);
+            heuristic -= lineScore(lineCount[1][l], lineCount[2][l]);
+            if (++lineCount[p][l] == k) { ++completed[p]; won = true; }
+            heuristic += lineScore(lineCount[1][l], lineCount[2][l]);
+            if (isThreat(p, l) != mine) markThreat(p, l, mine ? -1 : 1);
+            if (theirs) markThreat(3-p, l, -1);
+        }
+        if (wins->nearOnly) markNear(cell, 1);
+        return won;
+    }
+
+    void unmakeMove(int cell, int p) {
+        bb[p] &= ~Mask::bit(cell);
+        ++emptyCount;
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] ^= zobrist.cell[p][wins->sym[s][cell]];
+        for (int l : wins->linesThrough[cell]) {
+            const bool mine = isThreat(p, l), theirs = isThreat(3-p, l);
+            heuristic -= lineScore(lineCount[1][l], lineCount[2][l]);
+            if (lineCount[p][l]-- == k) --completed[p];
+            heuristic += lineScore(lineCount[1][l], lineCount[2][l]);
+            if (isThreat(p, l) != mine) markThreat(p, l, mine ? -1 : 1);
+            if (isThreat(3-p, l) != theirs) markThreat(3-p, l, 1);
+        }
+        if (wins->nearOnly) markNear(cell, -1);
+    }
+
+    bool hasWon(int p) const { return completed[p] > 0; }
+    bool isFull() const { return emptyCount == 0; }
+
+    // Index of the symmetry whose view of the board has the smallest key; that
+    // view is the canonical form shared by all 8 rotations/reflections.
+    int canonicalSym() const {
+        int best = 0;
+        for (int s=1;s<NUM_SYMS;s++) if (hashes[s] < hashes[best]) best = s;
+        return best;
+    }
+
+    // Empty cells that complete a line for p right now
+    Mask winningCells(int p) const { return threats[p] & emptyCells(); }
+
+    // Cells worth playing: every empty cell, or on nearOnly boards the empty
+    // cells near a stone (the centre on an empty board), so the search grows
+    // with the stones played rather than with the board.
+    Mask playableCells() const {
+        if (!wins->nearOnly) return emptyCells();
+        if (emptyCount == wins->cells) return Mask::bit(wins->centre);
+        Mask cells = near & emptyCells();
+        return cells ? cells : emptyCells();
+    }
+
+    // Moves that differ only by a symmetry of the current board are equivalent;
+    // keep the lowest-indexed cell of each class.
+    Mask distinctMoves() const {
+        Mask result;
+        for (Mask free = playableCells(); free; free.clearLowest()) {
+            int cell = lowestBit(free);
+            bool keep = true;
+            for (int s=1;s<NUM_SYMS && keep;s++)
+                if (hashes[s] == hashes[0] && wins->sym[s][cell] < cell) keep = false;
+            if (keep) result |= Mask::bit(cell);
+        }
+        return result;
+    }
+
+    // The same board with X and O exchanged, so the O-side search can play X
+    Position swapped() const {
+        Position s;
+        s.reset(rows, cols, k);
+        for (int p=1;p<=2;p++)
+            for (Mask m = bb[p]; m; m.clearLowest()) s.makeMove(lowestBit(m), 3 - p);
+        return s;
+    }
+};
+
+// ---------- Game ----------
+// One match under the rules: X (1) moves first, players alternate, and the
+// game ends when a player gets k in a row or the board is full.
+struct Game {
+    Position pos;
+    int toMove;    // 1 or 2
+    bool over;
+    int winner;    // 0 draw/none, 1 X, 2 O
+
+    explicit Game(int n = 3) { reset(n); }
+    Game(int rows, int cols, int k) { reset(rows, cols, k); }
+
+    void reset(int n) { reset(n, n, n); }
+
+    void reset(int rows, int cols, int k) {
+        pos.reset(rows, cols, k);
+        toMove = 1;
+        over = false;
+        winner = 0;
+    }
+
+    int cells() const { return pos.wins->cells; }
+    bool isLegal(int cell) const { return !over && cell >= 0 && cell < pos.wins->cells && pos.cellAt(cell) == 0; }
+
+    // Legal moves in cell order; returns how many
+    int legalMoves(int* moves) const {
+        int count = 0;
+        if (!over) for (Mask m = pos.emptyCells(); m; m.clearLowest()) moves[count++] = lowestBit(m);
+        return count;
+    }
+
+    // Plays cell for the side to move; false (and nothing changes) if it is illegal
+    bool play(int cell) {
+        if (!isLegal(cell)) return false;
+        if (pos.makeMove(cell, toMove)) {
+            over = true;
+            winner = toMove;
+        } else if (pos.isFull()) {
+            over = true;
+        } else {
+            toMove = 3 - toMove;
+        }
+        return true;
+    }
+};
+
+// ---------- Game pool ----------
+// Games for batch and server use, in one cache-aligned block allocated up
+// front. acquire/release only move an index on a free list, so starting or
+// ending a game never touches the heap. Not thread-safe: one pool per thread,
+// or guard it.
+class GamePool {
+private:
+    struct alignas(64) Slot {
+        Game game;
+        int nextFree;   // free list link; -1 ends it, -2 marks a slot in use
+    };
+    unique_ptr<Slot[]> slots;
+    int capacity_, firstFree, used_;
+
+public:
+    explicit GamePool(int capacity) : slots(new Slot[capacity]), capacity_(capacity), firstFree(0), used_(0) {
+        for (int i=0;i<capacity;i++) slots[i].nextFree = i+1 < capacity ? i+1 : -1;
+    }
+
+    int capacity() const { return capacity_; }
+    int used() const { return used_; }
+
+    // A new game on a rows x cols board, k in a row; nullptr when the pool is full
+    Game* acquire(int rows, int cols, int k) {
+        if (firstFree < 0) return nullptr;
+        Slot &s = slots[firstFree];
+        firstFree = s.nextFree;
+        s.nextFree = -2;
+        ++used_;
+        s.game.reset(rows, cols, k);
+        return &s.game;
+    }
+
+    // Releasing a game twice, or one not from acquire, would put its slot on
+    // the free list twice and hand the same Game out to two owners; debug
+    // builds stop there, release builds ignore the call.
+    void release(Game* g) {
+        int i = index(g);
+        const bool inUse = i >= 0 && i < capacity_ && slots[i].nextFree == -2;
+        assert(inUse && "GamePool::release: game not in use");
+        if (!inUse) return;
+        slots[i].nextFree = firstFree;
+        firstFree = i;
+        --used_;
+    }
+
+    // Stable slot number of a game from this pool, e.g. as a session id
+    int index(const Game* g) const {
+        return (int)(((const char*)g - (const char*)&slots[0].game) / sizeof(Slot));
+    }
+    Game* at(int i) { return slots[i].nextFree == -2 ? &slots[i].game : nullptr; }
+};
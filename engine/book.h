@@ -0,0 +1,284 @@
+// File: engine/book.h
+// Solved opening book for the small boards, generated offline and memory-mapped.
+#pragma once
+
+#include <vector>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "board.h"
+#include "search.h"
+
+using namespace std;
+
+// ---------- Opening book ----------
+// Perfect play for every reachable 3x3 and 4x4 position, solved offline by
+// `tictactoe --gen-book` and memory-mapped at startup.
+//
+// File layout (little-endian):
+//   BookHeader, then sectionCount BookSection records, then each section's slots.
+// A section is an open-addressing hash table of 64-bit slots, one per position
+// that is reachable, not finished and canonical (smallest base-3 index among
+// its 8 symmetric views):
+//   bits  0-25  base-3 board index + 1 (0 marks an empty slot)
+//   bits 26-31  value with best play: n*n+1-k if O wins k plies from here,
+//               -(n*n+1-k) if X does, 0 for a draw
+//   bits 32-47  every optimal move, as a cell mask in canonical orientation
+// Keeping all optimal moves lets a lookup apply the search's tie-break (lowest
+// cell) in the board's own orientation, so the book plays exactly as the search.
+const char BOOK_MAGIC[8] = {'T','T','T','B','O','O','K','\0'};
+const unsigned int BOOK_VERSION = 1;
+const int BOOK_MAX_N = 4;
+
+struct BookHeader {
+    char magic[8];
+    unsigned int version;
+    unsigned int sectionCount;
+};
+
+struct BookSection {
+    unsigned int n;
+    unsigned int entries;
+    unsigned long long slotCount;   // power of two
+    unsigned long long offset;      // of the first slot, from the start of the file
+};
+
+inline unsigned long long bookSlotHash(unsigned long long key, unsigned long long slotCount) {
+    return (key * 0x9E3779B97F4A7C15ULL >> 20) & (slotCount - 1);
+}
+
+// Base-3 index of the board (X = 1, O = 2 per cell) seen through symmetry s
+inline unsigned int boardIndex(const int* cells, int n, const WinTable &t, int s) {
+    int viewed[MAX_CELLS];
+    for (int c=0;c<n*n;c++) viewed[t.sym[s][c]] = cells[c];
+    unsigned int index = 0;
+    for (int c=n*n-1;c>=0;c--) index = index*3 + viewed[c];
+    return index;
+}
+
+class OpeningBook {
+private:
+    const unsigned char* base = nullptr;
+    size_t length = 0;
+    const BookSection* sections[BOOK_MAX_N + 1] = {};
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE, mapping = nullptr;
+#endif
+
+public:
+    ~OpeningBook() { close(); }
+
+    bool covers(int n) const { return n <= BOOK_MAX_N && sections[n] != nullptr; }
+
+    void close() {
+        if (base) {
+#ifdef _WIN32
+            UnmapViewOfFile(base);
+            CloseHandle(mapping);
+            CloseHandle(file);
+#else
+            munmap((void*)base, length);
+#endif
+        }
+        base = nullptr;
+        length = 0;
+        for (auto &s : sections) s = nullptr;
+    }
+
+    // Maps the file read-only; returns false (and stays empty) if it is missing or malformed.
+    bool load(const char* path) {
+        close();
+#ifdef _WIN32
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, 0, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return false;
+        LARGE_INTEGER size;
+        GetFileSizeEx(file, &size);
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) { CloseHandle(file); return false; }
+        base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!base) { CloseHandle(mapping); CloseHandle(file); return false; }
+        length = (size_t)size.QuadPart;
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(BookHeader)) { ::close(fd); return false; }
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+        base = (const unsigned char*)p;
+        length = st.st_size;
+#endif
+        const BookHeader* h = (const BookHeader*)base;
+        bool ok = length >= sizeof(BookHeader) && memcmp(h->magic, BOOK_MAGIC, 8) == 0
+               && h->version == BOOK_VERSION
+               && length >= sizeof(BookHeader) + h->sectionCount * sizeof(BookSection);
+        for (unsigned int i=0; ok && i<h->sectionCount; i++) {
+            const BookSection* s = (const BookSection*)(base + sizeof(BookHeader)) + i;
+            ok = s->n >= 3 && s->n <= (unsigned)BOOK_MAX_N && s->offset % 8 == 0
+              && s->offset + s->slotCount * 8 <= length;
+            if (ok) sections[s->n] = s;
+        }
+        if (!ok) close();
+        return ok;
+    }
+
+    // Book answer for the computer (O) to move in pos, as searchBestMove would return it.
+    // Only full-line (k = n) square boards are in the book. The book also holds
+    // X's moves, so a position with O not to move (X moves first) is left to the search.
+    bool probe(const Position &pos, SearchResult &r) const {
+        const int n = pos.rows;
+        if (pos.cols != n || pos.k != n || !covers(n)) return false;
+        if (popCount(pos.bb[1]) != popCount(pos.bb[2]) + 1) return false;
+        const BookSection* sec = sections[n];
+        const unsigned long long* slots = (const unsigned long long*)(base + sec->offset);
+        int cells[MAX_CELLS];
+        for (int c=0;c<n*n;c++) cells[c] = pos.cellAt(c);
+        int sym = 0;
+        unsigned int key = boardIndex(cells, n, *pos.wins, 0);
+        for (int s=1;s<NUM_SYMS;s++) {
+            unsigned int k = boardIndex(cells, n, *pos.wins, s);
+            if (k < key) { key = k; sym = s; }
+        }
+        const unsigned long long want = (unsigned long long)key + 1;
+        for (unsigned long long i = bookSlotHash(want, sec->slotCount);; i = (i + 1) & (sec->slotCount - 1)) {
+            unsigned long long slot = slots[i];
+            if (slot == 0) return false;
+            if ((slot & 0x3FFFFFF) != want) continue;
+            int value = (int)((slot >> 26) & 63);
+            if (value >= 32) value -= 64;
+            unsigned int moves = (unsigned int)(slot >> 32) & 0xFFFF;
+            r = SearchResult{-1, 0, 0, 0, 0, n*n - pos.emptyCount};
+            for (int m=0; m<n*n; m++)
+                if (moves & (1u << m)) {
+                    int cell = pos.wins->symInv[sym][m];
+                    if (r.cell < 0 || cell < r.cell) r.cell = cell;
+                }
+            // back to the search's score for the chosen move (O's point of view)
+            int plies = n*n + 1 - abs(value);
+            r.value = value == 0 ? 0 : value > 0 ? WIN_SCORE - (plies - 1) : -WIN_SCORE + (plies - 1);
+            r.depth = value == 0 ? pos.emptyCount : plies;
+            return true;
+        }
+    }
+};
+
+inline OpeningBook openingBook;   // --book, default tictactoe.book
+
+// Solves every reachable position of an n x n board by exhaustive search with a
+// memo over raw base-3 indices, then keeps the canonical ones.
+struct BookBuilder {
+    int n, cells;
+    const WinTable* t;
+    vector<signed char> memo;    // value per raw index; UNSEEN if not reached
+    vector<unsigned int> pow3;
+    static constexpr signed char UNSEEN = 127;
+
+    explicit BookBuilder(int size) : n(size), cells(size*size), t(&winTableFor(size)) {
+        pow3.assign(cells + 1, 1);
+        for (int c=1;c<=cells;c++) pow3[c] = pow3[c-1] * 3;
+        memo.assign(pow3[cells], UNSEEN);
+    }
+
+    static int shift(int v) { return v > 0 ? v - 1 : v < 0 ? v + 1 : 0; }
+
+    // Value of the position after `player` moved to `cell` (the position
+    // before is pos/index), from the parent's point of view.
+    int childValue(Position &pos, unsigned int index, int cell, int player) {
+        int v;
+        if (pos.makeMove(cell, player)) v = player == 2 ? cells + 1 : -(cells + 1);
+        else if (pos.isFull()) v = 0;
+        else v = solve(pos, index + player * pow3[cell], 3 - player);
+        pos.unmakeMove(cell, player);
+        return shift(v);
+    }
+
+    int solve(Position &pos, unsigned int index, int player) {
+        if (memo[index] != UNSEEN) return memo[index];
+        int best = player == 2 ? -1000 : 1000;
+        for (Mask free = pos.emptyCells(); free; free.clearLowest()) {
+            int v = childValue(pos, index, lowestBit(free), player);
+            best = player == 2 ? max(best, v) : min(best, v);
+        }
+        memo[index] = (signed char)best;
+        return best;
+    }
+
+    // Canonical, reachable, unfinished positions as book slots (without hashing)
+    vector<unsigned long long> entries() {
+        vector<unsigned long long> out;
+        int board[MAX_CELLS];
+        for (unsigned int index=0; index<memo.size(); index++) {
+            if (memo[index] == UNSEEN) continue;
+            for (int c=0, rest=index; c<cells; c++, rest/=3) board[c] = rest % 3;
+            bool canonical = true;
+            for (int s=1;s<NUM_SYMS && canonical;s++)
+                if (boardIndex(board, n, *t, s) < index) canonical = false;
+            if (!canonical) continue;
+            Position pos;
+            pos.reset(n);
+            int xs = 0, os = 0;
+            for (int c=0;c<cells;c++) if (board[c]) { pos.makeMove(c, board[c]); (board[c] == 1 ? xs : os)++; }
+            int player = xs == os ? 1 : 2;
+            unsigned int moves = 0;
+            for (Mask free = pos.emptyCells(); free; free.clearLowest()) {
+                int cell = lowestBit(free);
+                if (childValue(pos, index, cell, player) == memo[index]) moves |= 1u << cell;
+            }
+            out.push_back((unsigned long long)(index + 1)
+                        | (unsigned long long)(memo[index] & 63) << 26
+                        | (unsigned long long)moves << 32);
+        }
+        return out;
+    }
+};
+
+// Writes the 3x3 and 4x4 book to path; returns false on I/O failure.
+inline bool generateBook(const char* path) {
+    vector<vector<unsigned long long>> tables;
+    vector<BookSection> sections;
+    unsigned long long offset = sizeof(BookHeader) + 2 * sizeof(BookSection);
+    for (int n=3;n<=BOOK_MAX_N;n++) {
+        auto start = chrono::steady_clock::now();
+        BookBuilder builder(n);
+        Position pos;
+        pos.reset(n);
+        builder.solve(pos, 0, 1);
+        vector<unsigned long long> entries = builder.entries();
+        unsigned long long slotCount = 1;
+        while (slotCount < entries.size() * 3 / 2) slotCount *= 2;
+        vector<unsigned long long> slots(slotCount, 0);
+        for (unsigned long long e : entries) {
+            unsigned long long i = bookSlotHash(e & 0x3FFFFFF, slotCount);
+            while (slots[i]) i = (i + 1) & (slotCount - 1);
+            slots[i] = e;
+        }
+        sections.push_back(BookSection{(unsigned)n, (unsigned)entries.size(), slotCount, offset});
+        offset += slotCount * 8;
+        tables.push_back(move(slots));
+        printf("%dx%d: %zu positions, value of the empty board %d, %.1fs\n", n, n, entries.size(),
+               (int)builder.memo[0], chrono::duration<double>(chrono::steady_clock::now() - start).count());
+    }
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    BookHeader h;
+    memcpy(h.magic, BOOK_MAGIC, 8);
+    h.version = BOOK_VERSION;
+    h.sectionCount = (unsigned)sections.size();
+    bool ok = fwrite(&h, sizeof(h), 1, f) == 1
+           && fwrite(sections.data(), sizeof(BookSection), sections.size(), f) == sections.size();
+    for (auto &slots : tables)
+        ok = ok && fwrite(slots.data(), 8, slots.size(), f) == slots.size();
+    return fclose(f) == 0 && ok;
+}
+
@@ -0,0 +1,240 @@
+// File: engine/cache.h
+// Persistent search cache: root results of searchBestMove kept in a
+// fixed-size file that is mapped into memory, so a position searched in one
+// session (or by another process) is answered at once in the next.
+//   SearchCache c; c.open("tictactoe.cache", 4);   // created at 4 MB if missing
+//   if (!c.probe(pos, control, r)) {
+//       r = searchPosition(pos, control);
+//       c.store(pos, r.finishedCell, r.finishedValue, r.depth, control);
+//   }
+//
+// File layout, little-endian:
+//   header  "TTTC" u8 version u8 0 u16 0 u64 slots, zero padded to 64 bytes
+//   slots   two-entry buckets of {u64 key ^ data, u64 data}
+// The file is mapped shared, so every store lands in the page cache at once
+// and the kernel writes it back; other processes mapping the same file see
+// it immediately. Writers don't lock: like the transposition table, a slot
+// torn by a concurrent writer (or a crash) fails its key check. Only creating
+// the file takes an flock, so two processes starting together agree on its size.
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "board.h"
+#include "transposition.h"   // Bound, NO_MOVE
+#include "search.h"          // SearchResult, SearchControl
+
+using namespace std;
+
+// ---------- Format ----------
+const unsigned char CACHE_FILE_MAGIC[4] = {'T', 'T', 'T', 'C'};
+const int CACHE_VERSION = 1;
+const int CACHE_FILE_HEADER = 64;
+
+struct CacheSlot {
+    atomic<unsigned long long> check;   // key ^ data
+    atomic<unsigned long long> data;    // value:16 | depth:8 | bound:8 | move:8 | budget:24, move in the canonical view
+};
+static_assert(sizeof(CacheSlot) == 16, "cache slots are two 64-bit words");
+static_assert(atomic<unsigned long long>::is_always_lock_free, "cache slots are shared between processes");
+
+// The budget a depth-limited result was searched with: milliseconds, or with
+// CACHE_NODE_BUDGET set units of 1024 nodes; 0 for none. Saturates.
+const unsigned int CACHE_NODE_BUDGET = 1u << 23;
+const unsigned int CACHE_BUDGET_MAX = CACHE_NODE_BUDGET - 1;
+
+// ---------- Cache ----------
+class SearchCache {
+private:
+    unsigned char* base = nullptr;
+    size_t mappedBytes = 0;
+    CacheSlot* slots = nullptr;
+    size_t bucketMask = 0;
+
+    static unsigned long long pack(int value, int depth, int bound, int move, unsigned int budget) {
+        return (unsigned long long)(unsigned short)value
+             | (unsigned long long)depth << 16
+             | (unsigned long long)bound << 24
+             | (unsigned long long)move << 32
+             | (unsigned long long)budget << 40;
+    }
+    static bool solved(unsigned long long d, const Position &pos) {
+        return isWinScore((short)(d & 0xFFFF)) || (int)((d >> 16) & 0xFF) >= pos.emptyCount;
+    }
+    static unsigned int budgetOf(const SearchControl* control) {
+        if (!control) return 0;
+        if (control->timeLimit > 0) return (unsigned int)min(ceil(control->timeLimit * 1000), (double)CACHE_BUDGET_MAX);
+        if (control->nodeLimit > 0) return CACHE_NODE_BUDGET | (unsigned int)min((control->nodeLimit + 1023) / 1024, (long long)CACHE_BUDGET_MAX);
+        return 0;
+    }
+    // Solved entries outrank any depth-limited one
+    static int worth(unsigned long long d) {
+        const int value = (short)(d & 0xFFFF);
+        return isWinScore(value) ? 512 : (int)((d >> 16) & 0xFF);
+    }
+
+    // The computer (O) to move in the canonical view; the shape is in the hash
+    static unsigned long long keyOf(const Position &pos, int &sym) {
+        sym = pos.canonicalSym();
+        return pos.hashes[sym] ^ zobrist.toMove[2];
+    }
+
+public:
+    atomic<long long> hits{0}, misses{0}, stores{0};   // this process only
+
+    SearchCache() = default;
+    SearchCache(const SearchCache&) = delete;
+    SearchCache& operator=(const SearchCache&) = delete;
+    ~SearchCache() { close(); }
+
+    // Maps path, creating it with the largest power-of-two bucket count that
+    // fits in megabytes if it doesn't exist; an existing cache keeps its size.
+    // False if the file can't be mapped or isn't a cache of this version.
+    bool open(const string &path, size_t megabytes) {
+        close();
+#ifdef _WIN32
+        (void)path; (void)megabytes;
+        return false;   // no shared mapping; the game just searches
+#else
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) return false;
+        flock(fd, LOCK_EX);
+        struct stat st;
+        unsigned char header[CACHE_FILE_HEADER] = {};
+        unsigned long long slotCount = 0;
+        bool ok = fstat(fd, &st) == 0;
+        if (ok && st.st_size == 0) {
+            size_t buckets = 1;
+            while (buckets * 2 * 2 * sizeof(CacheSlot) <= megabytes * 1024 * 1024) buckets *= 2;
+            slotCount = buckets * 2;
+            memcpy(header, CACHE_FILE_MAGIC, 4);
+            header[4] = CACHE_VERSION;
+            memcpy(header + 8, &slotCount, 8);
+            ok = ftruncate(fd, (off_t)(CACHE_FILE_HEADER + slotCount * sizeof(CacheSlot))) == 0
+              && pwrite(fd, header, CACHE_FILE_HEADER, 0) == CACHE_FILE_HEADER;
+        } else if (ok) {
+            ok = pread(fd, header, CACHE_FILE_HEADER, 0) == CACHE_FILE_HEADER
+              && memcmp(header, CACHE_FILE_MAGIC, 4) == 0 && header[4] == CACHE_VERSION;
+            memcpy(&slotCount, header + 8, 8);
+            ok = ok && slotCount >= 2 && (slotCount & (slotCount - 1)) == 0
+              && (unsigned long long)st.st_size == CACHE_FILE_HEADER + slotCount * sizeof(CacheSlot);
+        }
+        flock(fd, LOCK_UN);
+        if (ok) {
+            mappedBytes = CACHE_FILE_HEADER + slotCount * sizeof(CacheSlot);
+            void* m = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (m == MAP_FAILED) ok = false;
+            else {
+                base = (unsigned char*)m;
+                slots = (CacheSlot*)(base + CACHE_FILE_HEADER);
+                bucketMask = slotCount / 2 - 1;
+            }
+        }
+        ::close(fd);   // the mapping keeps the file
+        if (!ok) close();
+        return ok;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (base) munmap(base, mappedBytes);
+#endif
+        base = nullptr;
+        slots = nullptr;
+        mappedBytes = 0;
+    }
+
+    bool isOpen() const { return slots != nullptr; }
+    size_t sizeBytes() const { return mappedBytes; }
+
+    // Share of slots in use
+    double fill() const {
+        if (!slots) return 0;
+        const size_t count = (bucketMask + 1) * 2;
+        size_t used = 0;
+        for (size_t i=0;i<count;i++) used += slots[i].data.load(memory_order_relaxed) != 0;
+        return (double)used / count;
+    }
+
+    // Cached answer for the computer (O) to move in pos. A solved result (a
+    // forced win or loss, or a search to the end of the game) always answers;
+    // a depth-limited one only answers a search with a budget of the same kind
+    // and no larger than the one that found it. A bigger budget searches again
+    // and its result replaces the old one.
+    bool probe(const Position &pos, const SearchControl* control, SearchResult &r) {
+        if (!slots) return false;
+        int sym;
+        const unsigned long long key = keyOf(pos, sym);
+        const CacheSlot* b = &slots[(key & bucketMask) * 2];
+        for (int i=0;i<2;i++) {
+            const unsigned long long d = b[i].data.load(memory_order_relaxed);
+            if (d == 0 || (b[i].check.load(memory_order_relaxed) ^ d) != key) continue;
+            const int value = (short)(d & 0xFFFF);
+            const int depth = (int)((d >> 16) & 0xFF);
+            const int bound = (int)((d >> 24) & 0xFF);
+            const int move = (int)((d >> 32) & 0xFF);
+            if (bound != BOUND_EXACT || move == NO_MOVE || move >= pos.rows * pos.cols) break;
+            if (!solved(d, pos)) {
+                const unsigned int budget = budgetOf(control), found = (unsigned int)(d >> 40);
+                if (budget == 0 || (budget & CACHE_NODE_BUDGET) != (found & CACHE_NODE_BUDGET) || budget > found) break;
+            }
+            const int cell = pos.wins->symInv[sym][move];
+            if (pos.cellAt(cell) != 0) break;   // a key collision
+            r = SearchResult{cell, value, 0, 0, 0, depth};
+            r.finishedCell = cell;   // the answer is a finished pass
+            r.finishedValue = value;
+            hits++;
+            return true;
+        }
+        misses++;
+        return false;
+    }
+
+    // Keeps the exact result of a finished search pass of depth plies, made
+    // under control's budget. It replaces the entry for pos unless that one is
+    // solved and this isn't, or is deeper and was found with a budget of the
+    // same kind at least as large; otherwise it takes the bucket's less
+    // valuable slot (a solved result beats a depth-limited one, a deeper
+    // search a shallower one).
+    void store(const Position &pos, int cell, int value, int depth, const SearchControl* control) {
+        if (!slots || cell < 0 || depth <= 0) return;
+        int sym;
+        const unsigned long long key = keyOf(pos, sym);
+        const unsigned long long data = pack(value, min(depth, 255), BOUND_EXACT, pos.wins->sym[sym][cell], budgetOf(control));
+        CacheSlot* b = &slots[(key & bucketMask) * 2];
+        int target = -1;
+        for (int i=0;i<2 && target<0;i++) {
+            const unsigned long long d = b[i].data.load(memory_order_relaxed);
+            if (d != 0 && (b[i].check.load(memory_order_relaxed) ^ d) == key) {
+                if (solved(d, pos) && !solved(data, pos)) return;
+                const unsigned int budget = (unsigned int)(data >> 40), found = (unsigned int)(d >> 40);
+                if (!solved(data, pos) && (budget & CACHE_NODE_BUDGET) == (found & CACHE_NODE_BUDGET)
+                    && ((d >> 16) & 0xFF) > ((data >> 16) & 0xFF) && budget <= found) return;
+                target = i;
+            }
+        }
+        if (target < 0) {
+            const unsigned long long d0 = b[0].data.load(memory_order_relaxed);
+            const unsigned long long d1 = b[1].data.load(memory_order_relaxed);
+            target = worth(d1) <= worth(d0) ? 1 : 0;   // an empty slot is worth 0
+        }
+        b[target].check.store(key ^ data, memory_order_relaxed);
+        b[target].data.store(data, memory_order_relaxed);
+        stores++;
+    }
+};
+
+// Opened by the game (--cache, default tictactoe.cache); closed means searchBestMove skips it
+inline SearchCache searchCache;
@@ -0,0 +1,51 @@
+// File: engine/engine.h
+// The tic-tac-toe engine without any GUI: include this and link with threads.
+//   Game g(4);                                   // rules and board: 4 x 4, four in a row
+//   Game gomoku(15, 15, 5);                      // any rows x cols board, k in a row
+//   SearchResult r = searchBestMove(g.pos);      // best cell for O
+//   SearchResult m = searchBestMoveMcts(g.pos);  // the same by Monte Carlo tree search
+//   g.play(r.cell);
+#pragma once
+
+#include "board.h"
+#include "transposition.h"
+#include "search.h"
+#include "book.h"
+#include "evaluate.h"
+#include "searchlog.h"
+#include "mcts.h"
+#include "record.h"
+#include "proof.h"
+#include "cache.h"
+
+// ---------- Best move ----------
+// Best move for the computer: straight from the opening book when it covers
+// the board size, else from the search cache when an earlier search (in any
+// session) answers it, else a forced win if df-pn proves one within
+// proofProbeNodes, otherwise searchPosition. The deepest finished pass of the
+// search goes to the cache; df-pn's wins don't (they aren't the fastest, and
+// the probe is cheap to repeat). r.seconds is the time it all took.
+inline SearchResult searchBestMove(const Position &pos, SearchControl* control = nullptr) {
+    const auto started = chrono::steady_clock::now();
+    SearchResult r;
+    if (control && control->stats) control->stats->clear();   // a book or cached move searches nothing
+    if (!openingBook.probe(pos, r) && !searchCache.probe(pos, control, r)) {
+        if (!probeForcedWin(pos, control, r)) {
+            const long long proofNodes = r.nodes;
+            r = searchPosition(pos, control);
+            r.nodes += proofNodes;
+            if (r.depth > 0 && r.cell >= 0) searchCache.store(pos, r.finishedCell, r.finishedValue, r.depth, control);
+        }
+    }
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    return r;
+}
+
+// The same with Monte Carlo tree search (engine/mcts.h) instead of the book
+// and alpha-beta; control->nodeLimit then counts playouts.
+inline SearchResult searchBestMoveMcts(const Position &pos, SearchControl* control = nullptr) {
+    const auto started = chrono::steady_clock::now();
+    SearchResult r = mctsSearcher.search(pos, control);
+    r.seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    return r;
+}
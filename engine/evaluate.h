@@ -0,0 +1,194 @@
+// File: engine/evaluate.h
+// Batch evaluation: result and heuristic score of many boards at once, with
+// AVX2 and SSE4.1 kernels picked at run time and a scalar fallback.
+#pragma once
+
+#include <vector>
+
+#include "board.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define TTT_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+using namespace std;
+
+// ---------- Batch evaluation ----------
+// Boards of up to 64 cells as one word per player, structure of
+// arrays: x[i] and o[i] are the cells of X and O on board i, bit i*cols + j.
+// For each board it reports what Searcher::evaluate and Position::heuristic
+// would: the result (O's win checked first) and the sum of lineScore over
+// every line, before the MAX_HEURISTIC clamp.
+//
+// The search itself keeps its incremental evaluation: alpha-beta reaches its
+// leaves one at a time. This is for bulk work over many stored positions.
+enum BoardResult : signed char { RESULT_NONE = 0, RESULT_X_WINS = 1, RESULT_O_WINS = 2, RESULT_DRAW = 3 };
+
+enum EvalKernel { EVAL_SCALAR, EVAL_SSE41, EVAL_AVX2 };
+const char* const EVAL_KERNEL_NAMES[] = {"scalar", "sse4.1", "avx2"};
+
+inline bool evalKernelSupported(EvalKernel kernel) {
+#ifdef TTT_X86_KERNELS
+    if (kernel == EVAL_AVX2) return __builtin_cpu_supports("avx2");
+    if (kernel == EVAL_SSE41) return __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3");
+#endif
+    return kernel == EVAL_SCALAR;
+}
+
+inline EvalKernel bestEvalKernel() {
+    if (evalKernelSupported(EVAL_AVX2)) return EVAL_AVX2;
+    if (evalKernelSupported(EVAL_SSE41)) return EVAL_SSE41;
+    return EVAL_SCALAR;
+}
+
+class BatchEvaluator {
+private:
+    int k;
+    unsigned long long full;
+    vector<unsigned long long> lines;
+    // LINE_WEIGHT split into bytes, for a 16-entry byte shuffle
+    unsigned char weightLo[16], weightHi[16];
+
+    static BoardResult resultOf(bool xWon, bool oWon, bool isFull) {
+        return oWon ? RESULT_O_WINS : xWon ? RESULT_X_WINS : isFull ? RESULT_DRAW : RESULT_NONE;
+    }
+
+    void evaluateScalar(const unsigned long long* x, const unsigned long long* o, int count,
+                        signed char* result, int* heuristic) const {
+        for (int i=0;i<count;i++) {
+            bool xWon = false, oWon = false;
+            int h = 0;
+            for (unsigned long long line : lines) {
+                int xc = __builtin_popcountll(x[i] & line), oc = __builtin_popcountll(o[i] & line);
+                xWon |= xc == k;
+                oWon |= oc == k;
+                h += lineScore(xc, oc);
+            }
+            result[i] = resultOf(xWon, oWon, (x[i] | o[i]) == full);
+            heuristic[i] = h;
+        }
+    }
+
+#ifdef TTT_X86_KERNELS
+    // Per 64-bit lane: popcount by nibble lookup and byte sums, then
+    // W[oc] where X has no mark on the line minus W[xc] where O has none.
+    __attribute__((target("avx2")))
+    static __m256i popcount256(__m256i v) {
+        const __m256i nibbleCount = _mm256_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4, 0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m256i lowNibble = _mm256_set1_epi8(0x0f);
+        __m256i c = _mm256_add_epi8(_mm256_shuffle_epi8(nibbleCount, _mm256_and_si256(v, lowNibble)),
+                                    _mm256_shuffle_epi8(nibbleCount, _mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibble)));
+        return _mm256_sad_epu8(c, _mm256_setzero_si256());
+    }
+
+    __attribute__((target("avx2")))
+    static __m256i weight256(__m256i lo, __m256i hi, __m256i c) {
+        return _mm256_or_si256(_mm256_shuffle_epi8(lo, c), _mm256_slli_epi64(_mm256_shuffle_epi8(hi, c), 8));
+    }
+
+    __attribute__((target("avx2")))
+    void evaluateAvx2(const unsigned long long* x, const unsigned long long* o, int count,
+                      signed char* result, int* heuristic) const {
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i lo = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)weightLo));
+        const __m256i hi = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)weightHi));
+        const __m256i kv = _mm256_set1_epi64x(k), fullv = _mm256_set1_epi64x((long long)full);
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m256i xv = _mm256_loadu_si256((const __m256i*)(x + i));
+            const __m256i ov = _mm256_loadu_si256((const __m256i*)(o + i));
+            __m256i h = zero, xWon = zero, oWon = zero;
+            for (unsigned long long line : lines) {
+                const __m256i lv = _mm256_set1_epi64x((long long)line);
+                const __m256i xc = popcount256(_mm256_and_si256(xv, lv)), oc = popcount256(_mm256_and_si256(ov, lv));
+                xWon = _mm256_or_si256(xWon, _mm256_cmpeq_epi64(xc, kv));
+                oWon = _mm256_or_si256(oWon, _mm256_cmpeq_epi64(oc, kv));
+                h = _mm256_add_epi64(h, _mm256_and_si256(_mm256_cmpeq_epi64(xc, zero), weight256(lo, hi, oc)));
+                h = _mm256_sub_epi64(h, _mm256_and_si256(_mm256_cmpeq_epi64(oc, zero), weight256(lo, hi, xc)));
+            }
+            const __m256i isFull = _mm256_cmpeq_epi64(_mm256_or_si256(xv, ov), fullv);
+            int xBits = _mm256_movemask_pd(_mm256_castsi256_pd(xWon));
+            int oBits = _mm256_movemask_pd(_mm256_castsi256_pd(oWon));
+            int fullBits = _mm256_movemask_pd(_mm256_castsi256_pd(isFull));
+            long long hs[4];
+            _mm256_storeu_si256((__m256i*)hs, h);
+            for (int j=0;j<4;j++) {
+                result[i+j] = resultOf(xBits >> j & 1, oBits >> j & 1, fullBits >> j & 1);
+                heuristic[i+j] = (int)hs[j];
+            }
+        }
+        evaluateScalar(x + i, o + i, count - i, result + i, heuristic + i);
+    }
+
+    __attribute__((target("sse4.1,ssse3")))
+    static __m128i popcount128(__m128i v) {
+        const __m128i nibbleCount = _mm_setr_epi8(0,1,1,2,1,2,2,3,1,2,2,3,2,3,3,4);
+        const __m128i lowNibble = _mm_set1_epi8(0x0f);
+        __m128i c = _mm_add_epi8(_mm_shuffle_epi8(nibbleCount, _mm_and_si128(v, lowNibble)),
+                                 _mm_shuffle_epi8(nibbleCount, _mm_and_si128(_mm_srli_epi16(v, 4), lowNibble)));
+        return _mm_sad_epu8(c, _mm_setzero_si128());
+    }
+
+    __attribute__((target("sse4.1,ssse3")))
+    static __m128i weight128(__m128i lo, __m128i hi, __m128i c) {
+        return _mm_or_si128(_mm_shuffle_epi8(lo, c), _mm_slli_epi64(_mm_shuffle_epi8(hi, c), 8));
+    }
+
+    __attribute__((target("sse4.1,ssse3")))
+    void evaluateSse41(const unsigned long long* x, const unsigned long long* o, int count,
+                       signed char* result, int* heuristic) const {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_loadu_si128((const __m128i*)weightLo), hi = _mm_loadu_si128((const __m128i*)weightHi);
+        const __m128i kv = _mm_set1_epi64x(k), fullv = _mm_set1_epi64x((long long)full);
+        int i = 0;
+        for (; i + 2 <= count; i += 2) {
+            const __m128i xv = _mm_loadu_si128((const __m128i*)(x + i));
+            const __m128i ov = _mm_loadu_si128((const __m128i*)(o + i));
+            __m128i h = zero, xWon = zero, oWon = zero;
+            for (unsigned long long line : lines) {
+                const __m128i lv = _mm_set1_epi64x((long long)line);
+                const __m128i xc = popcount128(_mm_and_si128(xv, lv)), oc = popcount128(_mm_and_si128(ov, lv));
+                xWon = _mm_or_si128(xWon, _mm_cmpeq_epi64(xc, kv));
+                oWon = _mm_or_si128(oWon, _mm_cmpeq_epi64(oc, kv));
+                h = _mm_add_epi64(h, _mm_and_si128(_mm_cmpeq_epi64(xc, zero), weight128(lo, hi, oc)));
+                h = _mm_sub_epi64(h, _mm_and_si128(_mm_cmpeq_epi64(oc, zero), weight128(lo, hi, xc)));
+            }
+            const __m128i isFull = _mm_cmpeq_epi64(_mm_or_si128(xv, ov), fullv);
+            int xBits = _mm_movemask_pd(_mm_castsi128_pd(xWon));
+            int oBits = _mm_movemask_pd(_mm_castsi128_pd(oWon));
+            int fullBits = _mm_movemask_pd(_mm_castsi128_pd(isFull));
+            long long hs[2];
+            _mm_storeu_si128((__m128i*)hs, h);
+            for (int j=0;j<2;j++) {
+                result[i+j] = resultOf(xBits >> j & 1, oBits >> j & 1, fullBits >> j & 1);
+                heuristic[i+j] = (int)hs[j];
+            }
+        }
+        evaluateScalar(x + i, o + i, count - i, result + i, heuristic + i);
+    }
+#endif
+
+public:
+    // Boards of rows x cols with k in a row; rows*cols must be at most 64
+    BatchEvaluator(int rows, int cols, int inRow) : k(inRow), full(0) {
+        const WinTable &t = winTableFor(rows, cols, inRow);
+        full = t.full.w[0];
+        for (const Mask &line : t.lines) lines.push_back(line.w[0]);
+        for (int c=0;c<16;c++) {
+            weightLo[c] = (unsigned char)(LINE_WEIGHT[c] & 255);
+            weightHi[c] = (unsigned char)(LINE_WEIGHT[c] >> 8);
+        }
+    }
+
+    static bool fits(int rows, int cols) { return rows*cols <= 64; }
+
+    void evaluate(const unsigned long long* x, const unsigned long long* o, int count,
+                  signed char* result, int* heuristic, EvalKernel kernel = bestEvalKernel()) const {
+#ifdef TTT_X86_KERNELS
+        if (kernel == EVAL_AVX2 && evalKernelSupported(EVAL_AVX2)) { evaluateAvx2(x, o, count, result, heuristic); return; }
+        if (kernel == EVAL_SSE41 && evalKernelSupported(EVAL_SSE41)) { evaluateSse41(x, o, count, result, heuristic); return; }
+#endif
+        evaluateScalar(x, o, count, result, heuristic);
+    }
+};
@@ -0,0 +1,163 @@
+// File: engine/fixed.h
+// Fixed-size boards for the search: an N x N, N-in-a-row position whose win
+// lines, symmetries and move tables are constexpr, for N = 3..FIXED_MAX_N.
+#pragma once
+
+#include "board.h"
+
+using namespace std;
+
+// ---------- Fixed-size tables ----------
+// The same lines, in the same order, and the same symmetry maps as
+// winTableFor(N), computed at compile time. Every loop over lines or
+// symmetries then has a constant trip count the compiler can unroll.
+const int FIXED_MAX_N = 8;   // N*N cells fit one 64-bit word
+
+template <int N>
+struct FixedTables {
+    static constexpr int CELLS = N*N;
+    static constexpr int LINES = 2*N + 2;   // rows, columns, 2 diagonals
+
+    unsigned long long full = 0;
+    unsigned long long lines[LINES] = {};
+    int linesThrough[CELLS][4] = {};
+    int lineTotal[CELLS] = {};          // entries used in linesThrough
+    int sym[NUM_SYMS][CELLS] = {};
+    int symInv[NUM_SYMS][CELLS] = {};
+    int cellWeight[CELLS] = {};
+
+    constexpr FixedTables() {
+        for (int c=0;c<CELLS;c++) full |= 1ULL << c;
+        for (int i=0;i<N;i++){
+            for (int j=0;j<N;j++){
+                lines[i] |= 1ULL << (i*N + j);       // row i
+                lines[N + i] |= 1ULL << (j*N + i);   // column i
+            }
+            lines[2*N] |= 1ULL << (i*N + i);
+            lines[2*N + 1] |= 1ULL << (i*N + (N-1-i));
+        }
+        for (int l=0;l<LINES;l++)
+            for (int c=0;c<CELLS;c++)
+                if (lines[l] >> c & 1) linesThrough[c][lineTotal[c]++] = l;
+        for (int c=0;c<CELLS;c++) cellWeight[c] = lineTotal[c];
+        for (int i=0;i<N;i++){
+            for (int j=0;j<N;j++){
+                const int r = N-1-i, c = N-1-j;
+                const int img[NUM_SYMS][2] = {
+                    {i,j}, {j,r}, {r,c}, {c,i},
+                    {i,c}, {r,j}, {j,i}, {c,r}
+                };
+                for (int s=0;s<NUM_SYMS;s++){
+                    sym[s][i*N + j] = img[s][0]*N + img[s][1];
+                    symInv[s][img[s][0]*N + img[s][1]] = i*N + j;
+                }
+            }
+        }
+    }
+};
+
+// ---------- Fixed-size position ----------
+// Position for one N x N, N-in-a-row board with one-word bitboards. It has
+// the interface BasicSearcher needs, and the same Zobrist keys as Position,
+// so both share the transposition table and search identically.
+template <int N>
+struct alignas(64) FixedPosition {
+    static_assert(N >= 3 && N <= FIXED_MAX_N, "fixed boards are 3..FIXED_MAX_N");
+    using MaskType = Mask64;
+    using Tables = FixedTables<N>;
+    static constexpr Tables table{};
+    static constexpr const Tables* wins = &table;
+
+    Mask64 bb[3];
+    unsigned char lineCount[3][Tables::LINES];
+    int completed[3];
+    int emptyCount;
+    unsigned long long hashes[NUM_SYMS];
+    int heuristic;
+
+    // The same board as pos, which must be N x N with k = N
+    explicit FixedPosition(const Position &pos) {
+        bb[0] = bb[1] = bb[2] = Mask64();
+        memset(lineCount, 0, sizeof(lineCount));
+        completed[0] = completed[1] = completed[2] = 0;
+        emptyCount = Tables::CELLS;
+        const unsigned long long shape = zobrist.size[N] ^ zobrist.cols[N] ^ zobrist.inRow[N];
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] = shape;
+        heuristic = 0;
+        for (int p=1;p<=2;p++)
+            for (Mask m = pos.bb[p]; m; m.clearLowest()) makeMove(lowestBit(m), p);
+    }
+
+    Mask64 emptyCells() const { return ~(bb[1] | bb[2]) & fullMask(); }
+    static Mask64 fullMask() { Mask64 m; m.w[0] = table.full; return m; }
+
+    int cellAt(int cell) const {
+        if (bb[1].w[0] >> cell & 1) return 1;
+        if (bb[2].w[0] >> cell & 1) return 2;
+        return 0;
+    }
+
+    bool makeMove(int cell, int p) {
+        bb[p].w[0] |= 1ULL << cell;
+        --emptyCount;
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] ^= zobrist.cell[p][table.sym[s][cell]];
+        bool won = false;
+        for (int t=0;t<table.lineTotal[cell];t++) {
+            const int l = table.linesThrough[cell][t];
+            heuristic -= lineScore(lineCount[1][l], lineCount[2][l]);
+            if (++lineCount[p][l] == N) { ++completed[p]; won = true; }
+            heuristic += lineScore(lineCount[1][l], lineCount[2][l]);
+        }
+        return won;
+    }
+
+    void unmakeMove(int cell, int p) {
+        bb[p].w[0] &= ~(1ULL << cell);
+        ++emptyCount;
+        for (int s=0;s<NUM_SYMS;s++) hashes[s] ^= zobrist.cell[p][table.sym[s][cell]];
+        for (int t=0;t<table.lineTotal[cell];t++) {
+            const int l = table.linesThrough[cell][t];
+            heuristic -= lineScore(lineCount[1][l], lineCount[2][l]);
+            if (lineCount[p][l]-- == N) --completed[p];
+            heuristic += lineScore(lineCount[1][l], lineCount[2][l]);
+        }
+    }
+
+    bool hasWon(int p) const { return completed[p] > 0; }
+    bool isFull() const { return emptyCount == 0; }
+
+    int canonicalSym() const {
+        int best = 0;
+        for (int s=1;s<NUM_SYMS;s++) if (hashes[s] < hashes[best]) best = s;
+        return best;
+    }
+
+    // A branch-free pass over the 2N+2 lines
+    Mask64 winningCells(int p) const {
+        const int opp = 3 - p;
+        Mask64 cells;
+        for (int l=0;l<Tables::LINES;l++)
+            cells.w[0] |= table.lines[l] & -(unsigned long long)(lineCount[p][l] == N-1 && lineCount[opp][l] == 0);
+        return cells & emptyCells();
+    }
+
+    Mask64 playableCells() const { return emptyCells(); }
+
+    Mask64 distinctMoves() const {
+        Mask64 result;
+        for (Mask64 free = emptyCells(); free; free.clearLowest()) {
+            int cell = lowestBit(free);
+            bool keep = true;
+            for (int s=1;s<NUM_SYMS && keep;s++)
+                if (hashes[s] == hashes[0] && table.sym[s][cell] < cell) keep = false;
+            if (keep) result.w[0] |= 1ULL << cell;
+        }
+        return result;
+    }
+};
+
+// Boards a FixedPosition can stand in for
+inline int fixedSize(const Position &pos) {
+    const bool fits = pos.rows == pos.cols && pos.k == pos.rows && pos.rows >= 3 && pos.rows <= FIXED_MAX_N;
+    return fits ? pos.rows : 0;
+}
@@ -0,0 +1,434 @@
+// File: engine/mcts.h
+// Monte Carlo tree search (UCT) as an alternative to the alpha-beta search
+// on large boards, where the heuristic cut-off misjudges long k-in-a-row
+// fights. Random playouts run on a compact copy of the board. Tree nodes
+// live in a preallocated arena, and the tree from the previous move is kept
+// when the game went down one of its branches. Several threads share the
+// tree: a thread walking down adds a virtual loss to each node on its way,
+// so the others spread out.
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cmath>
+#include <chrono>
+
+#include "board.h"
+#include "search.h"
+
+using namespace std;
+
+// ---------- Playout board ----------
+// The lines of one shape in the board's own width: one word up to 8x8,
+// MASK_WORDS beyond. Lines through a cell are flattened into one array.
+template <int WORDS>
+struct PlayoutTables {
+    const WinTable* wins = nullptr;
+    vector<BasicMask<WORDS>> lines;
+    vector<int> throughStart;   // cell -> first entry in through, cells+1 entries
+    vector<int> through;        // line indices, grouped by cell
+
+    void build(const WinTable &t) {
+        if (wins == &t) return;
+        wins = &t;
+        lines.assign(t.lines.size(), BasicMask<WORDS>());
+        for (size_t l=0;l<t.lines.size();l++)
+            for (int i=0;i<WORDS;i++) lines[l].w[i] = t.lines[l].w[i];
+        throughStart.assign(t.cells + 1, 0);
+        through.clear();
+        for (int c=0;c<t.cells;c++) {
+            throughStart[c] = (int)through.size();
+            through.insert(through.end(), t.linesThrough[c].begin(), t.linesThrough[c].end());
+        }
+        throughStart[t.cells] = (int)through.size();
+    }
+};
+
+// splitmix64, one per playout thread
+struct PlayoutRng {
+    unsigned long long x;
+    explicit PlayoutRng(unsigned long long seed) : x(seed) {}
+    unsigned long long next() {
+        unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    // n <= MAX_CELLS, so the high bits of one draw are plenty
+    int below(int n) { return (int)(((next() >> 32) * (unsigned long long)n) >> 32); }
+};
+
+// Bitboards plus the empty cells as a list, so a random move is one draw
+template <int WORDS>
+struct PlayoutBoard {
+    using M = BasicMask<WORDS>;
+    const PlayoutTables<WORDS>* t;
+    M bb[3];
+    int freeCount;
+    unsigned char freeCells[MAX_CELLS];   // empty cells, in no particular order
+    unsigned char slot[MAX_CELLS];        // cell -> index in freeCells
+
+    void init(const PlayoutTables<WORDS> &tables, const Position &pos) {
+        t = &tables;
+        for (int p=0;p<3;p++)
+            for (int i=0;i<WORDS;i++) bb[p].w[i] = pos.bb[p].w[i];
+        freeCount = 0;
+        for (Mask m = pos.emptyCells(); m; m.clearLowest()) {
+            const int c = lowestBit(m);
+            slot[c] = (unsigned char)freeCount;
+            freeCells[freeCount++] = (unsigned char)c;
+        }
+    }
+
+    bool isEmpty(int cell) const { return !((bb[1] | bb[2]) & M::bit(cell)); }
+
+    // Would p complete a line by playing cell
+    bool wins(int cell, int p) const {
+        const M mine = bb[p] | M::bit(cell);
+        for (int i=t->throughStart[cell];i<t->throughStart[cell + 1];i++) {
+            const M &line = t->lines[t->through[i]];
+            if ((line & mine) == line) return true;
+        }
+        return false;
+    }
+
+    void play(int cell, int p) {
+        bb[p] |= M::bit(cell);
+        const int i = slot[cell], last = freeCells[--freeCount];
+        freeCells[i] = (unsigned char)last;
+        slot[last] = (unsigned char)i;
+    }
+
+    // Uniformly random moves from p until someone wins; 0 for a draw
+    int playout(int p, PlayoutRng &rng) {
+        while (freeCount > 0) {
+            const int cell = freeCells[rng.below(freeCount)];
+            const bool won = wins(cell, p);
+            play(cell, p);
+            if (won) return p;
+            p = 3 - p;
+        }
+        return 0;
+    }
+};
+
+// ---------- Tree ----------
+enum MctsNodeState : unsigned char {
+    NODE_LEAF,        // not expanded yet
+    NODE_EXPANDING,   // a thread is creating its children
+    NODE_EXPANDED,
+    NODE_WON,         // the move into this node won the game
+    NODE_DRAWN,       // ... or filled the board
+};
+
+// 16 bytes. visits counts virtual losses still in flight, and score is in
+// half points (2 win, 1 draw) for the player who moved into the node.
+struct MctsNode {
+    atomic<int> visits;
+    atomic<int> score;
+    int firstChild;
+    unsigned short childCount;
+    unsigned char cell;
+    atomic<unsigned char> state;
+
+    void init(int c, MctsNodeState s) {
+        visits.store(0, memory_order_relaxed);
+        score.store(0, memory_order_relaxed);
+        firstChild = 0;
+        childCount = 0;
+        cell = (unsigned char)c;
+        state.store(s, memory_order_relaxed);
+    }
+    void copyFrom(const MctsNode &o) {
+        init(o.cell, (MctsNodeState)o.state.load(memory_order_relaxed));
+        visits.store(o.visits.load(memory_order_relaxed), memory_order_relaxed);
+        score.store(o.score.load(memory_order_relaxed), memory_order_relaxed);
+    }
+};
+
+const int MCTS_DEFAULT_NODES = 1 << 20;     // per arena; two arenas of 16 MB
+const long long MCTS_DEFAULT_PLAYOUTS = 20000;   // without a time or playout budget
+const int MCTS_BATCH = 32;                  // playouts between budget checks
+
+// ---------- Searcher ----------
+// Plays O (player 2), like searchPosition. control->nodeLimit counts playouts,
+// and control->nodes is their running total. Not reentrant: one search at a time.
+class MctsSearcher {
+public:
+    double exploration = 1.0;   // UCT constant c in Q + c*sqrt(ln N / n)
+    int virtualLoss = 3;        // visits added per thread passing through a node
+    int expandAfter = 8;        // visits a leaf needs before it gets children
+
+private:
+    int capacity = 0;
+    unique_ptr<MctsNode[]> arenas[2];   // the tree, and the spare it is compacted into
+    int current = 0;
+    atomic<int> used{0};
+    bool haveTree = false;
+    const WinTable* rootWins = nullptr;
+    Mask rootBb[3];                     // the position at node 0
+    PlayoutTables<1> smallTables;
+    PlayoutTables<MASK_WORDS> largeTables;
+    atomic<int> deepest{0};
+    unsigned long long seed = 0x6D637473ULL;
+
+    MctsNode* nodes() { return arenas[current].get(); }
+
+    void resetTree(const Position &pos) {
+        nodes()[0].init(255, NODE_LEAF);
+        used = 1;
+        for (int p=0;p<3;p++) rootBb[p] = pos.bb[p];
+        rootWins = pos.wins;
+        haveTree = true;
+    }
+
+    int childByCell(int node, int cell) {
+        MctsNode &n = nodes()[node];
+        if (n.state.load(memory_order_acquire) != NODE_EXPANDED) return -1;
+        for (int i=0;i<n.childCount;i++)
+            if (nodes()[n.firstChild + i].cell == cell) return n.firstChild + i;
+        return -1;
+    }
+
+    // Copies the subtree under root into the spare arena, breadth first, so it
+    // becomes node 0 there with its descendants packed behind it
+    void compactFrom(int root) {
+        MctsNode* src = nodes();
+        MctsNode* dst = arenas[1 - current].get();
+        dst[0].copyFrom(src[root]);
+        vector<pair<int, int>> queue = {{root, 0}};
+        int next = 1;
+        for (size_t q=0;q<queue.size();q++) {
+            const MctsNode &s = src[queue[q].first];
+            MctsNode &d = dst[queue[q].second];
+            if (s.state.load(memory_order_relaxed) != NODE_EXPANDED) continue;
+            d.firstChild = next;
+            d.childCount = s.childCount;
+            for (int i=0;i<s.childCount;i++) {
+                dst[next + i].copyFrom(src[s.firstChild + i]);
+                queue.push_back({s.firstChild + i, next + i});
+            }
+            next += s.childCount;
+        }
+        current = 1 - current;
+        used = next;
+    }
+
+    // Keeps the part of the old tree that pos is in: pos must extend the old
+    // root by O's move and X's reply (or equal it). Anything else starts over.
+    void advanceTo(const Position &pos) {
+        if (!haveTree || rootWins != pos.wins) { resetTree(pos); return; }
+        for (int p=1;p<=2;p++)
+            if (rootBb[p] & ~pos.bb[p]) { resetTree(pos); return; }
+        const Mask newO = pos.bb[2] & ~rootBb[2], newX = pos.bb[1] & ~rootBb[1];
+        if (!newO && !newX) return;
+        if (popCount(newO) != 1 || popCount(newX) != 1) { resetTree(pos); return; }
+        const int mine = childByCell(0, lowestBit(newO));
+        const int reply = mine < 0 ? -1 : childByCell(mine, lowestBit(newX));
+        if (reply < 0) { resetTree(pos); return; }
+        compactFrom(reply);
+        for (int p=0;p<3;p++) rootBb[p] = pos.bb[p];
+    }
+
+    // Creates the children of node: one per playable cell, marked terminal
+    // when the move ends the game. False if another thread got there first
+    // or the arena is full.
+    template <int WORDS>
+    bool expand(int node, const PlayoutBoard<WORDS> &b, int mover) {
+        MctsNode &n = nodes()[node];
+        unsigned char expected = NODE_LEAF;
+        if (!n.state.compare_exchange_strong(expected, NODE_EXPANDING, memory_order_acquire)) return false;
+        const WinTable &t = *b.t->wins;
+        const int empty = b.freeCount;
+        int cells[MAX_CELLS], count = 0;
+        if (t.nearOnly && empty < t.cells) {
+            // cells near a stone, as Position::playableCells
+            bool near[MAX_CELLS] = {};
+            for (int c=0;c<t.cells;c++)
+                if (!b.isEmpty(c))
+                    for (int nb : t.neighbours[c]) near[nb] = true;
+            for (int i=0;i<empty;i++)
+                if (near[b.freeCells[i]]) cells[count++] = b.freeCells[i];
+        }
+        if (count == 0) {
+            if (t.nearOnly && empty == t.cells) cells[count++] = t.centre;
+            else for (int i=0;i<empty;i++) cells[count++] = b.freeCells[i];
+        }
+        if (count == 0 || used.load(memory_order_relaxed) + count > capacity) {
+            n.state.store(NODE_LEAF, memory_order_release);
+            return false;
+        }
+        const int first = used.fetch_add(count);
+        if (first + count > capacity) {
+            n.state.store(NODE_LEAF, memory_order_release);
+            return false;
+        }
+        MctsNode* children = nodes() + first;
+        for (int i=0;i<count;i++) {
+            const int c = cells[i];
+            MctsNodeState s = NODE_LEAF;
+            if (b.wins(c, mover)) s = NODE_WON;
+            else if (empty == 1) s = NODE_DRAWN;
+            children[i].init(c, s);
+        }
+        n.firstChild = first;
+        n.childCount = (unsigned short)count;
+        n.state.store(NODE_EXPANDED, memory_order_release);
+        return true;
+    }
+
+    // UCT over the children of an expanded node; unvisited children first
+    int selectChild(const MctsNode &n) {
+        const double logN = log((double)max(1, n.visits.load(memory_order_relaxed)));
+        int best = n.firstChild;
+        double bestValue = -1;
+        for (int i=0;i<n.childCount;i++) {
+            const MctsNode &c = nodes()[n.firstChild + i];
+            const int v = c.visits.load(memory_order_relaxed);
+            if (v == 0) return n.firstChild + i;
+            const double q = c.score.load(memory_order_relaxed) / (2.0 * v);
+            const double value = q + exploration * sqrt(logN / v);
+            if (value > bestValue) { bestValue = value; best = n.firstChild + i; }
+        }
+        return best;
+    }
+
+    // One selection, expansion, playout and backup from the root
+    template <int WORDS>
+    void iterate(const PlayoutBoard<WORDS> &rootBoard, PlayoutRng &rng) {
+        PlayoutBoard<WORDS> b = rootBoard;
+        int path[MAX_CELLS + 1], depth = 0;
+        int node = 0;
+        int mover = 2;   // player to move at node
+        path[0] = 0;
+        nodes()[0].visits.fetch_add(virtualLoss, memory_order_relaxed);
+        int winner = -1;
+        for (;;) {
+            MctsNode &n = nodes()[node];
+            const unsigned char s = n.state.load(memory_order_acquire);
+            if (s == NODE_WON) { winner = 3 - mover; break; }
+            if (s == NODE_DRAWN) { winner = 0; break; }
+            if (s != NODE_EXPANDED) {
+                // visits include this thread's virtual loss
+                if (s != NODE_LEAF || n.visits.load(memory_order_relaxed) < virtualLoss + expandAfter - 1
+                    || !expand(node, b, mover)) break;
+            }
+            node = selectChild(n);
+            MctsNode &child = nodes()[node];
+            child.visits.fetch_add(virtualLoss, memory_order_relaxed);
+            b.play(child.cell, mover);
+            path[++depth] = node;
+            mover = 3 - mover;
+        }
+        if (winner < 0) winner = b.playout(mover, rng);
+        // the mover into path[d] is X for d = 0 (the root), then alternates
+        for (int d=0;d<=depth;d++) {
+            MctsNode &n = nodes()[path[d]];
+            const int movedIn = d % 2 == 0 ? 1 : 2;
+            n.visits.fetch_add(1 - virtualLoss, memory_order_relaxed);
+            n.score.fetch_add(winner == movedIn ? 2 : winner == 0 ? 1 : 0, memory_order_relaxed);
+        }
+        for (int seen = deepest.load(memory_order_relaxed); depth > seen && !deepest.compare_exchange_weak(seen, depth);) {}
+    }
+
+    template <int WORDS>
+    long long runThreads(const Position &pos, PlayoutTables<WORDS> &tables, SearchControl* control, int threadCount) {
+        tables.build(*pos.wins);
+        PlayoutBoard<WORDS> rootBoard;
+        rootBoard.init(tables, pos);
+        expand(0, rootBoard, 2);
+        atomic<long long> playouts{0};
+        // a time limit alone leaves the playouts open; no budget at all gets the default
+        long long cap = MCTS_DEFAULT_PLAYOUTS;
+        if (control && control->nodeLimit > 0) cap = control->nodeLimit;
+        else if (control && control->timeLimit > 0) cap = 0;
+        const unsigned long long base = seed;
+        seed += 0x9E3779B97F4A7C15ULL;
+        auto work = [&](int id) {
+            PlayoutRng rng(base ^ (0xA24BAED4963EE407ULL * (id + 1)));
+            for (;;) {
+                if (control && control->outOfBudget()) return;
+                const long long done = playouts.fetch_add(MCTS_BATCH);
+                if (cap > 0 && done >= cap) return;
+                for (int i=0;i<MCTS_BATCH;i++) iterate(rootBoard, rng);
+                if (control) control->nodes += MCTS_BATCH;
+            }
+        };
+        if (threadCount > 1) {
+            searchPool.resize(threadCount);
+            searchPool.run(work);
+        } else {
+            work(0);
+        }
+        return nodes()[0].visits.load();
+    }
+
+public:
+    explicit MctsSearcher(int nodeCapacity = MCTS_DEFAULT_NODES) : capacity(nodeCapacity) {}
+
+    // Arena size in nodes (two arenas are kept); drops the current tree
+    void resize(int nodeCapacity) {
+        capacity = max(MAX_CELLS + 1, nodeCapacity);
+        arenas[0].reset();
+        arenas[1].reset();
+        haveTree = false;
+    }
+
+    void clear() { haveTree = false; }
+
+    // Nodes of the tree kept for the next move
+    int treeSize() const { return haveTree ? min(used.load(), capacity) : 0; }
+
+    // Best move for O in pos. Takes an immediate win, blocks X's immediate
+    // win, and otherwise plays the most visited root move. The value is the
+    // move's average playout result from O's view, scaled to -100..100;
+    // nodes is the number of playouts. Returns cell -1 if the board is full
+    // or control->stop was raised.
+    SearchResult search(const Position &pos, SearchControl* control = nullptr, int threadCount = searchThreads) {
+        SearchResult r = {-1, 0, 0, 0, 0, 0};
+        if (pos.isFull() || pos.hasWon(1) || pos.hasWon(2)) return r;
+        if (!arenas[0]) {
+            arenas[0].reset(new MctsNode[capacity]);
+            arenas[1].reset(new MctsNode[capacity]);
+            haveTree = false;
+        }
+        advanceTo(pos);
+        if (Mask w = pos.winningCells(2)) {
+            r.cell = lowestBit(w);
+            r.value = 100;
+            r.depth = 1;
+            return r;
+        }
+        if (Mask w = pos.winningCells(1)) {
+            r.cell = lowestBit(w);
+            r.value = popCount(w) > 1 ? -100 : 0;
+            r.depth = 1;
+            return r;
+        }
+        deepest = 0;
+        const int before = nodes()[0].visits.load();
+        const int after = pos.wins->cells <= 64 ? runThreads(pos, smallTables, control, threadCount)
+                                                : runThreads(pos, largeTables, control, threadCount);
+        r.nodes = after - before;
+        r.depth = deepest.load() + 1;   // counting the playout's first move
+        const MctsNode &root = nodes()[0];
+        if (root.state.load() != NODE_EXPANDED) return r;
+        int best = -1;
+        for (int i=0;i<root.childCount;i++) {
+            const MctsNode &c = nodes()[root.firstChild + i];
+            if (c.state.load() == NODE_WON) { best = root.firstChild + i; break; }
+            if (best < 0 || c.visits > nodes()[best].visits
+                || (c.visits == nodes()[best].visits && c.score > nodes()[best].score)) best = root.firstChild + i;
+        }
+        if (control && control->stop) return r;
+        const MctsNode &c = nodes()[best];
+        r.cell = c.cell;
+        const int v = max(1, c.visits.load());
+        r.value = (int)lround((c.score.load() / (2.0 * v) - 0.5) * 200);
+        return r;
+    }
+};
+
+// The computer's MCTS engine; the tree carries over between its moves
+inline MctsSearcher mctsSearcher;
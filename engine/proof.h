@@ -0,0 +1,310 @@
+// File: engine/proof.h
+// Depth-first proof-number search (df-pn) over a Position: proves that the
+// side to move wins, loses or draws without giving every line a value.
+// Forced sequences, where alpha-beta still walks every reply, are where it
+// shines: it follows the moves that are closest to a proof.
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstring>
+#include <algorithm>
+#include <chrono>
+
+#include "board.h"
+#include "search.h"
+
+using namespace std;
+
+// ---------- Proof table ----------
+// Proof and disproof numbers per position, keyed by the canonical Zobrist
+// key (all 8 symmetries share an entry). Fixed size: two-entry buckets, and
+// a full bucket gives up the entry that took less work to find.
+const unsigned int PN_INF = 1u << 30;
+
+struct ProofEntry {
+    unsigned long long key;   // 0 = empty
+    unsigned int pn, dn;
+    unsigned long long work;  // nodes spent below the position
+};
+
+class ProofTable {
+private:
+    unique_ptr<ProofEntry[]> entries;
+    size_t bucketMask = 0;
+
+public:
+    explicit ProofTable(size_t megabytes = 16) { resize(megabytes); }
+
+    // Rounds the budget down to a power-of-two number of buckets (at least one).
+    void resize(size_t megabytes) {
+        size_t buckets = 1;
+        while (buckets * 2 * 2 * sizeof(ProofEntry) <= megabytes * 1024 * 1024) buckets *= 2;
+        entries.reset(new ProofEntry[buckets * 2]);
+        bucketMask = buckets - 1;
+        clear();
+    }
+
+    void clear() { memset(entries.get(), 0, sizeBytes()); }
+    size_t sizeBytes() const { return (bucketMask + 1) * 2 * sizeof(ProofEntry); }
+
+    bool probe(unsigned long long key, unsigned int &pn, unsigned int &dn) const {
+        const ProofEntry* b = &entries[(key & bucketMask) * 2];
+        for (int i=0;i<2;i++) {
+            if (b[i].key == key) {
+                pn = b[i].pn;
+                dn = b[i].dn;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(unsigned long long key, unsigned int pn, unsigned int dn, unsigned long long work) {
+        ProofEntry* b = &entries[(key & bucketMask) * 2];
+        ProofEntry* e = b[0].key == key || b[1].key == key ? (b[0].key == key ? &b[0] : &b[1])
+                      : b[0].work <= b[1].work ? &b[0] : &b[1];
+        e->work = e->key == key ? max(e->work, work) : work;
+        e->key = key;
+        e->pn = pn;
+        e->dn = dn;
+    }
+
+    // Share of the entries in use, from a sample
+    double fill() const {
+        const size_t sample = min<size_t>((bucketMask + 1) * 2, 1 << 16);
+        size_t used = 0;
+        for (size_t i=0;i<sample;i++) used += entries[i].key != 0;
+        return (double)used / sample;
+    }
+};
+
+// ---------- Solver ----------
+enum ProofResult { PROOF_UNKNOWN, PROOF_WIN, PROOF_LOSS, PROOF_DRAW };
+const char* const PROOF_RESULT_NAMES[] = {"unknown", "win", "loss", "draw"};
+
+// One proof at a time: "the attacker wins" is proven (pn = 0) or disproven
+// (dn = 0); a draw disproves it. The defender may play any empty cell, so a
+// proven win always holds. findForcedWin lets the attacker play only the
+// search's candidates (on nearOnly boards, cells near a stone), so there a
+// disproof only means no win through those. solve runs a proof for each side
+// to tell a win, a loss and a draw apart, with the attacker free to play
+// anywhere, so its draws and losses hold too.
+class ProofSolver {
+public:
+    ProofTable table;
+    long long nodes = 0;
+    long long nodeLimit = 0;             // per proof, 0 = unlimited
+    SearchControl* control = nullptr;    // optional: stop and time limit
+    double timeShare = 1;                // of control->timeLimit this solver may use
+    double epsilon = 0.25;               // 1+epsilon trick: children get thresholds a little past the runner-up
+
+private:
+    Position pos;
+    int attacker = 2;
+    bool wholeBoard = false;   // the attacker may play any empty cell
+    bool aborted = false;
+    int rootCell = -1;
+    long long limitAt = 0;
+    // Children per ply, kept here so a deep proof doesn't grow the stack
+    vector<int> cellStack;
+    vector<unsigned long long> keyStack;
+
+    unsigned long long salt(int toMove) const {
+        return (attacker == 1 ? 0x9D39247E33776D41ULL : 0) ^ (toMove == 1 ? 0x2AF7398005AAA5C7ULL : 0)
+             ^ (wholeBoard ? 0x6A09E667F3BCC908ULL : 0);
+    }
+
+    // Canonical key of the position after p plays cell, without playing it
+    unsigned long long childKey(int cell, int p) const {
+        unsigned long long best = ~0ULL;
+        for (int s=0;s<NUM_SYMS;s++) best = min(best, pos.hashes[s] ^ zobrist.cell[p][pos.wins->sym[s][cell]]);
+        return (best ^ salt(3 - p)) | 1;
+    }
+    unsigned long long keyOf(int toMove) const {
+        return (pos.hashes[pos.canonicalSym()] ^ salt(toMove)) | 1;
+    }
+
+    // Moves of p worth trying here, one per symmetry class. Returns -1 for
+    // a position decided before any move: pn/dn are set.
+    int children(int p, int* cells, unsigned int &pn, unsigned int &dn) const {
+        const bool orNode = p == attacker;
+        if (pos.winningCells(p)) {
+            pn = orNode ? 0 : PN_INF;
+            dn = orNode ? PN_INF : 0;
+            return -1;
+        }
+        const Mask threats = pos.winningCells(3 - p);
+        if (popCount(threats) >= 2) {   // one block can't stop both
+            pn = orNode ? PN_INF : 0;
+            dn = orNode ? 0 : PN_INF;
+            return -1;
+        }
+        if (threats) {
+            cells[0] = lowestBit(threats);
+            return 1;
+        }
+        int count = 0;
+        for (Mask m = orNode && !wholeBoard ? pos.playableCells() : pos.emptyCells(); m; m.clearLowest()) {
+            const int cell = lowestBit(m);
+            bool keep = true;
+            for (int s=1;s<NUM_SYMS && keep;s++)
+                if (pos.hashes[s] == pos.hashes[0] && pos.wins->sym[s][cell] < cell) keep = false;
+            if (keep) cells[count++] = cell;
+        }
+        return count;
+    }
+
+    bool outOfBudget() {
+        if (nodes >= limitAt && nodeLimit > 0) return true;
+        if (!control || (nodes & (NODE_BATCH - 1)) != 0) return false;
+        if (control->stop) return true;
+        return control->timeLimit > 0
+            && chrono::duration<double>(chrono::steady_clock::now() - control->started).count() >= control->timeLimit * timeShare;
+    }
+
+    // The df-pn recursion: works below the position until its proof or
+    // disproof number reaches its threshold
+    void mid(int p, int ply, unsigned int thpn, unsigned int thdn, unsigned int &pn, unsigned int &dn) {
+        ++nodes;
+        const long long startNodes = nodes;
+        const unsigned long long key = keyOf(p);
+        int* cells = &cellStack[ply * MAX_CELLS];
+        unsigned long long* keys = &keyStack[ply * MAX_CELLS];
+        const int count = children(p, cells, pn, dn);
+        if (count < 0) {
+            table.store(key, pn, dn, 1);
+            return;
+        }
+        const bool orNode = p == attacker;
+        const bool fills = pos.emptyCount == 1;   // every child is a draw
+        for (int i=0;i<count;i++) keys[i] = childKey(cells[i], p);
+        for (;;) {
+            // pn/dn from the children: OR takes the min proof and sums the
+            // disproofs, AND the other way round
+            unsigned int best = PN_INF, second = PN_INF, sum = 0, bestOther = 0;
+            int bestIndex = 0;
+            for (int i=0;i<count;i++) {
+                unsigned int cpn = 1, cdn = 1;
+                if (fills) { cpn = PN_INF; cdn = 0; }
+                else table.probe(keys[i], cpn, cdn);
+                const unsigned int mine = orNode ? cpn : cdn, other = orNode ? cdn : cpn;
+                sum = min(PN_INF, sum + other);
+                if (mine < best) {
+                    second = best;
+                    best = mine;
+                    bestOther = other;
+                    bestIndex = i;
+                } else if (mine < second) {
+                    second = mine;
+                }
+            }
+            pn = orNode ? best : sum;
+            dn = orNode ? sum : best;
+            if (ply == 0 && best == 0) rootCell = cells[bestIndex];
+            if (pn >= thpn || dn >= thdn || fills || aborted) break;
+            if (outOfBudget()) { aborted = true; break; }
+            // Thresholds for the most proving child
+            const unsigned int runnerUp = second >= PN_INF ? PN_INF : min<unsigned long long>(PN_INF, second + (unsigned long long)(second * epsilon) + 1);
+            const unsigned int thMine = min(orNode ? thpn : thdn, runnerUp);
+            const unsigned int thOther = (orNode ? thdn : thpn) >= PN_INF ? PN_INF
+                                       : (orNode ? thdn : thpn) - (sum - bestOther);
+            unsigned int cpn, cdn;
+            pos.makeMove(cells[bestIndex], p);
+            if (orNode) mid(3 - p, ply + 1, thMine, thOther, cpn, cdn);
+            else mid(3 - p, ply + 1, thOther, thMine, cpn, cdn);
+            pos.unmakeMove(cells[bestIndex], p);
+        }
+        table.store(key, pn, dn, nodes - startNodes + 1);
+    }
+
+    // Proves or disproves "who wins" from the position with toMove to play
+    // (the board must not be over). True if settled; proven tells which way.
+    bool prove(int toMove, int who, bool &proven) {
+        attacker = who;
+        aborted = false;
+        rootCell = -1;
+        if (Mask w = pos.winningCells(toMove)) rootCell = lowestBit(w);   // decided before mid looks at moves
+        limitAt = nodes + nodeLimit;
+        unsigned int pn = 1, dn = 1;
+        while (pn != 0 && dn != 0 && !aborted) mid(toMove, 0, PN_INF, PN_INF, pn, dn);
+        proven = pn == 0;
+        return pn == 0 || dn == 0;
+    }
+
+public:
+    explicit ProofSolver(size_t megabytes = 16) : table(megabytes), cellStack((MAX_CELLS + 1) * MAX_CELLS),
+                                                  keyStack((MAX_CELLS + 1) * MAX_CELLS) {}
+
+    // Side to move when X moved first: O after an odd number of stones
+    static int sideToMove(const Position &p) { return popCount(p.bb[1]) > popCount(p.bb[2]) ? 2 : 1; }
+
+    // Does toMove have a forced win? With nodeLimit or control the answer
+    // may be "don't know" (false with cell -1); a proven win sets cell to a
+    // move that keeps it.
+    bool findForcedWin(const Position &start, int toMove, int &cell) {
+        cell = -1;
+        pos = start;
+        if (pos.hasWon(1) || pos.hasWon(2) || pos.isFull()) return false;
+        wholeBoard = false;
+        bool proven;
+        if (!prove(toMove, toMove, proven) || !proven) return false;
+        cell = rootCell;
+        return cell >= 0;
+    }
+
+    // Game-theoretic value for the side to move and a move that achieves it
+    // (cell -1 if the game is over or the budget ran out first)
+    ProofResult solve(const Position &start, int toMove, int &cell) {
+        cell = -1;
+        pos = start;
+        if (pos.hasWon(toMove)) return PROOF_WIN;
+        if (pos.hasWon(3 - toMove)) return PROOF_LOSS;
+        if (pos.isFull()) return PROOF_DRAW;
+        wholeBoard = true;   // a disproof must cover every attacking move
+        bool proven;
+        if (!prove(toMove, toMove, proven)) return PROOF_UNKNOWN;
+        if (proven) {
+            cell = rootCell;
+            return PROOF_WIN;
+        }
+        // No win: either the opponent wins whatever we do, or a move holds the draw
+        if (!prove(toMove, 3 - toMove, proven)) return PROOF_UNKNOWN;
+        if (proven) {
+            int moves[MAX_CELLS];
+            unsigned int pn, dn;
+            const int count = children(toMove, moves, pn, dn);
+            cell = count > 0 ? moves[0] : lowestBit(pos.emptyCells());
+            return PROOF_LOSS;
+        }
+        cell = rootCell;
+        return PROOF_DRAW;
+    }
+};
+
+// ---------- Forced wins for the computer ----------
+// searchBestMove asks df-pn first whether O has a forced win, within this many
+// nodes (0 = never) and a quarter of the move's time; on boards the opening
+// book doesn't cover alpha-beta then skips the long forced lines. Its nodes
+// count against proofProbeNodes only, not control->nodeLimit, so a failed
+// probe leaves the search its whole node budget. Each search thread has its
+// own small table.
+inline long long proofProbeNodes = 20000;   // --proof-nodes
+const size_t PROOF_PROBE_MB = 4;
+const double PROOF_PROBE_TIME_SHARE = 0.25;
+
+inline bool probeForcedWin(const Position &pos, SearchControl* control, SearchResult &r) {
+    r = {-1, 0, 0, 0, 0, 0};
+    if (proofProbeNodes <= 0 || pos.emptyCount <= 9) return false;
+    thread_local unique_ptr<ProofSolver> solver;
+    if (!solver) solver.reset(new ProofSolver(PROOF_PROBE_MB));
+    solver->table.clear();
+    solver->nodes = 0;
+    solver->nodeLimit = proofProbeNodes;
+    solver->control = control;
+    solver->timeShare = PROOF_PROBE_TIME_SHARE;
+    int cell;
+    const bool won = solver->findForcedWin(pos, 2, cell);
+    r = {cell, WIN_SCORE - MAX_CELLS, solver->nodes, 0, 0, 0};   // a win, distance not known
+    return won && !(control && control->stop);
+}
@@ -0,0 +1,374 @@
+// File: engine/record.h
+// Game archives: every game as six header bytes and one byte per move,
+// appended to a file in checksummed blocks, and read back through a memory
+// map so millions of games replay without a parse step.
+//   GameRecordWriter w; w.open("tictactoe.games"); w.write(record); w.close();
+//   GameArchive a; a.open("tictactoe.games");
+//   a.forEach([](const GameRecordView &g) { ... });
+//
+// File layout, little-endian:
+//   header  "TTTR" u8 version u8 0 u16 0
+//   blocks  u32 BLOCK_MAGIC u32 payload bytes u32 games u32 CRC-32 of the payload
+//           then the payload: games back to back, each
+//           u8 rows u8 cols u8 k u8 RecordMode u8 BoardResult u8 moves, then one cell per move
+// A block torn by a crash fails its checksum; the reader skips to the next
+// block magic, so appending after a damaged tail loses nothing else.
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <mutex>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "board.h"
+#include "evaluate.h"   // BoardResult
+
+using namespace std;
+
+// ---------- Format ----------
+const unsigned char RECORD_FILE_MAGIC[4] = {'T', 'T', 'T', 'R'};
+const int RECORD_VERSION = 1;
+const int RECORD_FILE_HEADER = 8;
+const unsigned int BLOCK_MAGIC = 0x4B4C4254;   // "TBLK"
+const int BLOCK_HEADER = 16;
+const int GAME_HEADER = 6;
+const size_t BLOCK_PAYLOAD = 64 * 1024;        // the writer starts a new block past this
+
+// Who played the game
+enum RecordMode : unsigned char {
+    RECORD_UNKNOWN = 0,
+    RECORD_HUMAN_VS_HUMAN = 1,
+    RECORD_VS_MINIMAX = 2,   // human X against the alpha-beta engine
+    RECORD_VS_MCTS = 3,      // human X against MctsSearcher
+    RECORD_SELF_PLAY = 4,
+    RECORD_MODES
+};
+const char* const RECORD_MODE_NAMES[RECORD_MODES] = {"unknown", "human-vs-human", "vs-minimax", "vs-mcts", "self-play"};
+
+// CRC-32 (IEEE), eight bytes per step through eight tables (slicing-by-8)
+inline unsigned int crc32Of(const unsigned char* p, size_t n, unsigned int crc = 0) {
+    static const auto table = [] {
+        vector<unsigned int> t(8*256);
+        for (unsigned int i=0;i<256;i++) {
+            unsigned int c = i;
+            for (int b=0;b<8;b++) c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        for (int s=1;s<8;s++)
+            for (int i=0;i<256;i++) t[s*256 + i] = (t[(s-1)*256 + i] >> 8) ^ t[t[(s-1)*256 + i] & 255];
+        return t;
+    }();
+    const unsigned int* t = table.data();
+    crc = ~crc;
+    for (; n >= 8; p += 8, n -= 8) {
+        const unsigned int lo = crc ^ (p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24);
+        const unsigned int hi = p[4] | p[5] << 8 | p[6] << 16 | (unsigned int)p[7] << 24;
+        crc = t[7*256 + (lo & 255)] ^ t[6*256 + (lo >> 8 & 255)] ^ t[5*256 + (lo >> 16 & 255)] ^ t[4*256 + (lo >> 24)]
+            ^ t[3*256 + (hi & 255)] ^ t[2*256 + (hi >> 8 & 255)] ^ t[256 + (hi >> 16 & 255)] ^ t[hi >> 24];
+    }
+    for (; n > 0; p++, n--) crc = t[(crc ^ *p) & 255] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline unsigned int readU32(const unsigned char* p) {
+    return p[0] | p[1] << 8 | p[2] << 16 | (unsigned int)p[3] << 24;
+}
+inline void appendU32(vector<unsigned char> &out, unsigned int v) {
+    for (int i=0;i<4;i++) out.push_back((unsigned char)(v >> 8*i));
+}
+
+// ---------- Records ----------
+// A game as it is played: the shape, who played it and the cells in order
+struct GameRecord {
+    int rows = 3, cols = 3, k = 3;
+    RecordMode mode = RECORD_UNKNOWN;
+    BoardResult result = RESULT_NONE;   // RESULT_NONE: abandoned before the end
+    int moveCount = 0;
+    unsigned char moves[MAX_CELLS];
+
+    void start(int r, int c, int inRow, RecordMode m) {
+        rows = r; cols = c; k = inRow;
+        mode = m;
+        result = RESULT_NONE;
+        moveCount = 0;
+    }
+    void add(int cell) { if (moveCount < MAX_CELLS) moves[moveCount++] = (unsigned char)cell; }
+};
+
+// A game inside a mapped archive; moves points into the map
+struct GameRecordView {
+    int rows, cols, k;
+    RecordMode mode;
+    BoardResult result;
+    int moveCount;
+    const unsigned char* moves;
+};
+
+// Games encoded back to back, the payload of one block
+struct GameRecordBlock {
+    vector<unsigned char> payload;
+    unsigned int games = 0;
+
+    void add(const GameRecord &g) {
+        const unsigned char header[GAME_HEADER] = {(unsigned char)g.rows, (unsigned char)g.cols, (unsigned char)g.k,
+                                                   g.mode, (unsigned char)g.result, (unsigned char)g.moveCount};
+        payload.insert(payload.end(), header, header + GAME_HEADER);
+        payload.insert(payload.end(), g.moves, g.moves + g.moveCount);
+        ++games;
+    }
+    bool full() const { return payload.size() >= BLOCK_PAYLOAD; }
+    void clear() { payload.clear(); games = 0; }
+};
+
+inline BoardResult gameResult(const Game &g) {
+    if (!g.over) return RESULT_NONE;
+    return g.winner == 1 ? RESULT_X_WINS : g.winner == 2 ? RESULT_O_WINS : RESULT_DRAW;
+}
+
+// Replays the first plies moves of g (all with plies < 0) into out; false if
+// the record does not describe a legal game
+inline bool replayRecord(const GameRecordView &g, Game &out, int plies = -1) {
+    if (!validShape(g.rows, g.cols, g.k)) return false;
+    out.reset(g.rows, g.cols, g.k);
+    const int count = plies < 0 ? g.moveCount : min(plies, g.moveCount);
+    for (int i=0;i<count;i++)
+        if (!out.play(g.moves[i])) return false;
+    return true;
+}
+
+// ---------- Writer ----------
+// Appends to an archive, one block per BLOCK_PAYLOAD bytes of games. write
+// buffers; flush ends the block early so the games are on disk. appendBlock
+// hands over a block built elsewhere, e.g. by a worker thread, and may be
+// called from several threads at once. A failed or short write (a full disk)
+// stops the writer and sets failed(); the reader skips the torn block.
+class GameRecordWriter {
+private:
+    FILE* f = nullptr;
+    GameRecordBlock pending;
+    vector<unsigned char> header;
+    mutex lock;
+    long long games = 0, bytes = 0;
+    bool writeFailed = false;
+
+    void writeBlock(const GameRecordBlock &b) {
+        if (!f || writeFailed || b.games == 0) return;
+        header.clear();
+        appendU32(header, BLOCK_MAGIC);
+        appendU32(header, (unsigned int)b.payload.size());
+        appendU32(header, b.games);
+        appendU32(header, crc32Of(b.payload.data(), b.payload.size()));
+        if (fwrite(header.data(), 1, header.size(), f) != header.size()
+            || fwrite(b.payload.data(), 1, b.payload.size(), f) != b.payload.size()) {
+            writeFailed = true;
+            return;
+        }
+        games += b.games;
+        bytes += BLOCK_HEADER + b.payload.size();
+    }
+
+public:
+    GameRecordWriter() = default;
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+    ~GameRecordWriter() { close(); }
+
+    bool isOpen() const { return f != nullptr; }
+    bool failed() const { return writeFailed; }
+    long long gamesWritten() const { return games; }
+    long long bytesWritten() const { return bytes; }
+
+    // Appends to path, creating it if needed; false if it cannot be written
+    // or already holds something other than an archive
+    bool open(const string &path) {
+        close();
+        writeFailed = false;
+        f = fopen(path.c_str(), "ab+");
+        if (!f) return false;
+        fseek(f, 0, SEEK_END);
+        if (ftell(f) == 0) {
+            const unsigned char h[RECORD_FILE_HEADER] = {RECORD_FILE_MAGIC[0], RECORD_FILE_MAGIC[1], RECORD_FILE_MAGIC[2],
+                                                         RECORD_FILE_MAGIC[3], RECORD_VERSION, 0, 0, 0};
+            if (fwrite(h, 1, sizeof(h), f) != sizeof(h) || fflush(f) != 0) {
+                fclose(f);
+                f = nullptr;
+                return false;
+            }
+        } else {
+            unsigned char h[RECORD_FILE_HEADER];
+            fseek(f, 0, SEEK_SET);
+            if (fread(h, 1, sizeof(h), f) != sizeof(h) || memcmp(h, RECORD_FILE_MAGIC, 4) != 0 || h[4] != RECORD_VERSION) {
+                fclose(f);
+                f = nullptr;
+                return false;
+            }
+            fseek(f, 0, SEEK_END);   // "a" writes at the end anyway; this orders the read before it
+        }
+        return true;
+    }
+
+    void write(const GameRecord &g) {
+        lock_guard<mutex> guard(lock);
+        if (!f) return;
+        pending.add(g);
+        if (pending.full()) {
+            writeBlock(pending);
+            pending.clear();
+        }
+    }
+
+    // Writes b as one block and empties it
+    void appendBlock(GameRecordBlock &b) {
+        lock_guard<mutex> guard(lock);
+        writeBlock(b);
+        b.clear();
+    }
+
+    void flush() {
+        lock_guard<mutex> guard(lock);
+        writeBlock(pending);
+        pending.clear();
+        if (f && !writeFailed && fflush(f) != 0) writeFailed = true;
+    }
+
+    // False if any game since open failed to reach the file
+    bool close() {
+        if (!f) return !writeFailed;
+        flush();
+        if (fclose(f) != 0) writeFailed = true;
+        f = nullptr;
+        return !writeFailed;
+    }
+};
+
+// ---------- Reader ----------
+// A read-only view of a whole archive: mapped on POSIX, read into memory
+// elsewhere. forEach walks the blocks in order and hands every game to f.
+class GameArchive {
+private:
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    vector<unsigned char> copy;   // without mmap
+    vector<size_t> offsets;       // game index -> offset, built by index()
+
+    static GameRecordView viewAt(const unsigned char* p) {
+        GameRecordView g;
+        g.rows = p[0]; g.cols = p[1]; g.k = p[2];
+        g.mode = p[3] < RECORD_MODES ? (RecordMode)p[3] : RECORD_UNKNOWN;
+        g.result = (BoardResult)p[4];
+        g.moveCount = p[5];
+        g.moves = p + GAME_HEADER;
+        return g;
+    }
+
+    // The block at pos, if it is whole and its checksum matches
+    bool blockAt(size_t pos, size_t &payloadBytes, unsigned int &games, bool verify) const {
+        if (pos + BLOCK_HEADER > size || readU32(data + pos) != BLOCK_MAGIC) return false;
+        payloadBytes = readU32(data + pos + 4);
+        games = readU32(data + pos + 8);
+        if (payloadBytes > size - pos - BLOCK_HEADER) return false;
+        return !verify || crc32Of(data + pos + BLOCK_HEADER, payloadBytes) == readU32(data + pos + 12);
+    }
+
+public:
+    long long blocks = 0, badBlocks = 0;   // from the last forEach or index
+
+    GameArchive() = default;
+    GameArchive(const GameArchive&) = delete;
+    GameArchive& operator=(const GameArchive&) = delete;
+    ~GameArchive() { close(); }
+
+    bool open(const string &path) {
+        close();
+#ifdef _WIN32
+        FILE* f = fopen(path.c_str(), "rb");
+        if (!f) return false;
+        unsigned char buf[65536];
+        for (size_t got; (got = fread(buf, 1, sizeof(buf), f)) > 0; ) copy.insert(copy.end(), buf, buf + got);
+        fclose(f);
+        data = copy.data();
+        size = copy.size();
+#else
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= RECORD_FILE_HEADER) {
+            void* m = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED) {
+                madvise(m, (size_t)st.st_size, MADV_SEQUENTIAL);
+                data = (const unsigned char*)m;
+                size = (size_t)st.st_size;
+            }
+        }
+        ::close(fd);
+#endif
+        if (size < RECORD_FILE_HEADER || memcmp(data, RECORD_FILE_MAGIC, 4) != 0 || data[4] != RECORD_VERSION) {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (data && copy.empty()) munmap((void*)data, size);
+#endif
+        copy.clear();
+        offsets.clear();
+        data = nullptr;
+        size = 0;
+    }
+
+    size_t bytes() const { return size; }
+
+    // Calls f(const GameRecordView&) for every game in every good block and
+    // returns how many there were. A bad block is counted and skipped up to
+    // the next block magic. verify = false skips the checksums.
+    template <class F>
+    long long forEach(const F &f, bool verify = true) {
+        blocks = badBlocks = 0;
+        long long count = 0;
+        size_t pos = RECORD_FILE_HEADER;
+        while (pos + BLOCK_HEADER <= size) {
+            size_t payloadBytes;
+            unsigned int games;
+            if (!blockAt(pos, payloadBytes, games, verify)) {
+                ++badBlocks;
+                // resynchronise on the next magic
+                for (++pos; pos + BLOCK_HEADER <= size && readU32(data + pos) != BLOCK_MAGIC; ++pos) {}
+                continue;
+            }
+            ++blocks;
+            const unsigned char* p = data + pos + BLOCK_HEADER;
+            const unsigned char* end = p + payloadBytes;
+            for (unsigned int i=0;i<games && p + GAME_HEADER <= end;i++) {
+                const GameRecordView g = viewAt(p);
+                if (g.moves + g.moveCount > end) break;
+                f(g);
+                ++count;
+                p = g.moves + g.moveCount;
+            }
+            pos += BLOCK_HEADER + payloadBytes;
+        }
+        if (pos < size) ++badBlocks;   // a torn block header at the end
+        return count;
+    }
+
+    // Offsets of every game, for random access through game(i)
+    long long index(bool verify = true) {
+        offsets.clear();
+        forEach([&](const GameRecordView &g) { offsets.push_back(g.moves - GAME_HEADER - data); }, verify);
+        return (long long)offsets.size();
+    }
+    long long indexedGames() const { return (long long)offsets.size(); }
+
+    GameRecordView game(long long i) const { return viewAt(data + offsets[i]); }
+};
@@ -0,0 +1,617 @@
+// File: engine/search.h
+// Alpha-beta search over a Position: the serial Searcher, the work-stealing
+// parallel root split and iterative deepening under a time or node budget.
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include <chrono>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+#include "board.h"
+#include "fixed.h"
+#include "transposition.h"
+
+using namespace std;
+
+// ---------- Search ----------
+struct SearchResult {
+    int cell;            // chosen cell, -1 if the board is full
+    int value;           // minimax value of that move (O's point of view)
+    long long nodes;     // minimaxAB calls
+    long long ttHits, ttMisses;
+    int depth;           // plies searched from the root, counting the root move
+    double seconds = 0;  // wall time of the whole move, set by searchBestMove
+    // The deepest pass that finished: its move and value belong to depth. cell
+    // and value can come from a deeper pass that ran out of budget part way.
+    int finishedCell = -1, finishedValue = 0;
+};
+
+// ---------- Instrumentation ----------
+// Optional counters for one move. The search only touches them through a
+// pointer that is null unless the caller asked for them, so switched off
+// they cost one predictable branch per interior node and per cutoff.
+struct SearchStats {
+    long long interior;              // nodes that searched at least one move
+    long long movesSearched;         // children visited from those nodes
+    long long cutoffs[MAX_CELLS+1];  // beta cutoffs by ply (1 = the reply to the root move)
+    long long firstMoveCutoffs;      // cutoffs on the first move tried: move ordering at work
+
+    SearchStats() { clear(); }
+    void clear() { memset(this, 0, sizeof(*this)); }
+
+    void add(const SearchStats &o) {
+        interior += o.interior;
+        movesSearched += o.movesSearched;
+        for (int i=0;i<=MAX_CELLS;i++) cutoffs[i] += o.cutoffs[i];
+        firstMoveCutoffs += o.firstMoveCutoffs;
+    }
+
+    long long totalCutoffs() const {
+        long long total = 0;
+        for (int i=0;i<=MAX_CELLS;i++) total += cutoffs[i];
+        return total;
+    }
+    // Average moves searched per interior node
+    double branching() const { return interior ? (double)movesSearched / interior : 0; }
+    // Deepest ply with a cutoff, 0 if none
+    int deepestCutoff() const {
+        for (int i=MAX_CELLS;i>0;i--) if (cutoffs[i]) return i;
+        return 0;
+    }
+};
+
+// Shared between a running search and whoever started it. The budget ends the
+// search early with the best move found so far; stop abandons it altogether.
+struct SearchControl {
+    atomic<bool> stop{false};        // set to abandon the search; its result is then meaningless
+    atomic<long long> nodes{0};      // progress, published every NODE_BATCH nodes
+    double timeLimit = 0;            // seconds per move, 0 = unlimited
+    long long nodeLimit = 0;         // nodes per move, 0 = unlimited
+    SearchStats* stats = nullptr;    // optional: filled by the search when set
+    chrono::steady_clock::time_point started;
+
+    void start() {
+        stop = false;
+        nodes = 0;
+        if (stats) stats->clear();
+        started = chrono::steady_clock::now();
+    }
+
+    bool outOfBudget() const {
+        if (stop) return true;
+        if (nodeLimit > 0 && nodes >= nodeLimit) return true;
+        return timeLimit > 0
+            && chrono::duration<double>(chrono::steady_clock::now() - started).count() >= timeLimit;
+    }
+};
+const int NODE_BATCH = 1024;
+
+// One searcher per thread: its own copy of the position and its own move-ordering memory.
+// Board is Position, or a FixedPosition<N> for a size known at compile time.
+template <class Board>
+class BasicSearcher {
+public:
+    using Cells = typename Board::MaskType;
+    Board pos;
+    long long nodes;
+    long long ttHits, ttMisses;
+    SearchControl* control;   // optional
+    SearchStats* stats;       // optional, from control
+    bool aborted;             // control ran out; nothing is stored from then on
+    int maxDepth;             // plies below the root move before the heuristic takes over
+
+private:
+    int history[3][MAX_CELLS];   // [player][cell] credit for causing cutoffs
+    int killers[MAX_CELLS][2];   // [depth] last two quiet moves that cut off
+
+    // Win scores depend on the depth they were found at; the table keeps them
+    // relative to the stored node so they stay valid from any root.
+    static int valueToTT(int v, int depth) {
+        if (!isWinScore(v)) return v;
+        return v > 0 ? v + depth : v - depth;
+    }
+    static int valueFromTT(int v, int depth) {
+        if (!isWinScore(v)) return v;
+        return v > 0 ? v - depth : v + depth;
+    }
+
+    void rememberCutoff(int p, int depth, int cell) {
+        history[p][cell] += (pos.emptyCount + 1) * (pos.emptyCount + 1);
+        if (killers[depth][0] != cell) {
+            killers[depth][1] = killers[depth][0];
+            killers[depth][0] = cell;
+        }
+    }
+
+    void countCutoff(int depth, int moveIndex) {
+        if (!stats) return;
+        stats->cutoffs[depth + 1]++;
+        if (moveIndex == 0) stats->firstMoveCutoffs++;
+    }
+
+public:
+    explicit BasicSearcher(const Board& p, SearchControl* c = nullptr)
+        : pos(p), nodes(0), ttHits(0), ttMisses(0), control(c), stats(c ? c->stats : nullptr),
+          aborted(false), maxDepth(MAX_CELLS) {
+        memset(history, 0, sizeof(history));
+        memset(killers, -1, sizeof(killers));
+    }
+
+    // Evaluate: +WIN_SCORE - depth if O wins, -WIN_SCORE + depth if X wins, 0 draw
+    int evaluate(int depth) {
+        if (pos.hasWon(2)) return WIN_SCORE - depth;
+        if (pos.hasWon(1)) return -WIN_SCORE + depth;
+        return 0;
+    }
+
+    // Score of a non-terminal position at the depth limit
+    int heuristicValue() const {
+        return max(-MAX_HEURISTIC, min(MAX_HEURISTIC, pos.heuristic));
+    }
+
+    // Fill moves[] from the given cells, best first: the table move, immediate
+    // wins, forced blocks, then centre/corners with killers and history breaking ties.
+    int orderMoves(Cells cells, int p, int depth, int ttMove, int* moves) {
+        const Cells winCells = pos.winningCells(p), blocks = pos.winningCells(3 - p);
+        int scores[MAX_CELLS];
+        int count = 0;
+        for (Cells free = cells; free; free.clearLowest()) {
+            int cell = lowestBit(free);
+            Cells bit = Cells::bit(cell);
+            int score;
+            if (cell == ttMove) score = 1 << 30;
+            else if (winCells & bit) score = 1 << 29;
+            else if (blocks & bit) score = 1 << 28;
+            else {
+                score = pos.wins->cellWeight[cell] << 22;
+                if (cell == killers[depth][0] || cell == killers[depth][1]) score += 1 << 21;
+                score += min(history[p][cell], (1 << 21) - 1);
+            }
+            // insertion sort; equal scores keep row-major order
+            int k = count++;
+            while (k > 0 && scores[k-1] < score) { scores[k] = scores[k-1]; moves[k] = moves[k-1]; --k; }
+            scores[k] = score; moves[k] = cell;
+        }
+        return count;
+    }
+
+    // Moves worth searching for the side to move p: the playable cells, or only
+    // the blocking ones when the opponent threatens to win (anything else loses at
+    // once, which no block scores below).
+    Cells candidateMoves(int p) const {
+        Cells cells = pos.winningCells(3 - p);
+        return cells ? cells : pos.playableCells();
+    }
+
+    int minimaxAB(bool isMaximizing, int depth, int alpha, int beta) {
+        if (++nodes % NODE_BATCH == 0 && control) {
+            control->nodes += NODE_BATCH;
+            if (control->outOfBudget()) aborted = true;
+        }
+        if (aborted) return 0;
+        if (pos.hasWon(2) || pos.hasWon(1) || pos.isFull()) {
+            return evaluate(depth);
+        }
+        if (depth >= maxDepth) return heuristicValue();
+        const int me = isMaximizing ? 2 : 1;
+        // Transposition table lookup on the canonical position and side to move. An entry only
+        // answers for the same remaining depth, so every position is scored the
+        // same way whatever else is in the table; that keeps depth-limited
+        // results identical between the serial and the parallel search.
+        const int sym = pos.canonicalSym();
+        const unsigned long long key = pos.hashes[sym] ^ zobrist.toMove[me];
+        const int draft = min(maxDepth - depth, pos.emptyCount);
+        int ttValue, ttDepth, ttBound, ttMove = NO_MOVE;
+        if (transTable.probe(key, ttValue, ttDepth, ttBound, ttMove)) {
+            ++ttHits;
+            if (ttDepth == draft) {
+                ttValue = valueFromTT(ttValue, depth);
+                if (ttBound == BOUND_EXACT) return ttValue;
+                if (ttBound == BOUND_LOWER && ttValue >= beta) return ttValue;
+                if (ttBound == BOUND_UPPER && ttValue <= alpha) return ttValue;
+            }
+        } else {
+            ++ttMisses;
+        }
+        // A win on this move is the best any move can score
+        Cells winNow = pos.winningCells(me);
+        if (winNow) {
+            int val = isMaximizing ? WIN_SCORE - (depth+1) : -WIN_SCORE + (depth+1);
+            transTable.store(key, valueToTT(val, depth), draft, BOUND_EXACT,
+                             pos.wins->sym[sym][lowestBit(winNow)]);
+            return val;
+        }
+        int moves[MAX_CELLS];
+        int count = orderMoves(candidateMoves(me), me, depth,
+                               ttMove == NO_MOVE ? -1 : pos.wins->symInv[sym][ttMove], moves);
+        const int alphaOrig = alpha, betaOrig = beta;
+        int best, bestCell = moves[0];
+        if (stats) stats->interior++;
+        if (isMaximizing) {
+            best = numeric_limits<int>::min();
+            for(int k=0;k<count;k++){
+                int cell = moves[k];
+                pos.makeMove(cell, 2);
+                if (stats) stats->movesSearched++;
+                int val = minimaxAB(false, depth+1, alpha, beta);
+                pos.unmakeMove(cell, 2);
+                if (aborted) return 0;
+                if (val > best) { best = val; bestCell = cell; }
+                alpha = max(alpha, best);
+                if(beta <= alpha) { rememberCutoff(2, depth, cell); countCutoff(depth, k); break; }
+            }
+        } else {
+            best = numeric_limits<int>::max();
+            for(int k=0;k<count;k++){
+                int cell = moves[k];
+                pos.makeMove(cell, 1);
+                if (stats) stats->movesSearched++;
+                int val = minimaxAB(true, depth+1, alpha, beta);
+                pos.unmakeMove(cell, 1);
+                if (aborted) return 0;
+                if (val < best) { best = val; bestCell = cell; }
+                beta = min(beta, best);
+                if(beta <= alpha) { rememberCutoff(1, depth, cell); countCutoff(depth, k); break; }
+            }
+        }
+        int bound = best <= alphaOrig ? BOUND_UPPER : best >= betaOrig ? BOUND_LOWER : BOUND_EXACT;
+        transTable.store(key, valueToTT(best, depth), draft, bound, pos.wins->sym[sym][bestCell]);
+        return best;
+    }
+
+    // Root moves for the computer (player 2), one per symmetry class, best first;
+    // firstMove (e.g. the previous iteration's choice) goes ahead of the rest.
+    int rootMoves(int* moves, int firstMove = -1) {
+        return orderMoves(pos.distinctMoves(), 2, 0, firstMove, moves);
+    }
+
+    // Serial search to maxDepth. Ties go to the lowest cell index (row-major
+    // first), whatever order the moves are searched in. If the budget runs out,
+    // the result covers only the root moves finished so far (cell -1 if none).
+    SearchResult findBestMove(int firstMove = -1) {
+        SearchResult r = {-1, numeric_limits<int>::min(), 0, 0, 0, 0};
+        long long nodesBefore = nodes, hitsBefore = ttHits, missesBefore = ttMisses;
+        int moves[MAX_CELLS];
+        int count = rootMoves(moves, firstMove);
+        for(int k=0;k<count;k++){
+            int cell = moves[k];
+            // an earlier cell only needs to tie the best, a later one must beat it
+            int alpha = r.cell < 0 ? numeric_limits<int>::min()
+                      : cell < r.cell ? r.value - 1 : r.value;
+            pos.makeMove(cell, 2);
+            int moveVal = minimaxAB(false, 0, alpha, numeric_limits<int>::max());
+            pos.unmakeMove(cell, 2);
+            if (aborted) break;
+            if(moveVal > r.value || (moveVal == r.value && cell < r.cell)){
+                r.value = moveVal;
+                r.cell = cell;
+            }
+        }
+        r.nodes = nodes - nodesBefore;
+        r.ttHits = ttHits - hitsBefore;
+        r.ttMisses = ttMisses - missesBefore;
+        r.depth = aborted ? 0 : min(maxDepth + 1, pos.emptyCount);
+        return r;
+    }
+};
+
+using Searcher = BasicSearcher<Position>;
+template <int N> using FixedSearcher = BasicSearcher<FixedPosition<N>>;
+
+// Calls f(searcher) with a serial searcher for pos: a FixedSearcher<N> when a
+// fixed-size engine covers the board (square, full lines, N = 3..FIXED_MAX_N),
+// the generic Searcher otherwise. Both return the same moves and values.
+template <class F>
+auto withSearcher(const Position &pos, SearchControl* control, F f) {
+    switch (fixedSize(pos)) {
+    case 3: { FixedSearcher<3> s(FixedPosition<3>(pos), control); return f(s); }
+    case 4: { FixedSearcher<4> s(FixedPosition<4>(pos), control); return f(s); }
+    case 5: { FixedSearcher<5> s(FixedPosition<5>(pos), control); return f(s); }
+    case 6: { FixedSearcher<6> s(FixedPosition<6>(pos), control); return f(s); }
+    case 7: { FixedSearcher<7> s(FixedPosition<7>(pos), control); return f(s); }
+    case 8: { FixedSearcher<8> s(FixedPosition<8>(pos), control); return f(s); }
+    default: { Searcher s(pos, control); return f(s); }
+    }
+}
+
+
+// ---------- Parallel search ----------
+// Persistent worker threads; run() hands the same job to every thread
+// (the caller acts as worker 0) and returns when all of them are done.
+class SearchPool {
+private:
+    vector<thread> helpers;
+    mutex m;
+    condition_variable wake, finished;
+    void (*job)(const void*, int) = nullptr;   // the caller's callable, without a std::function copy
+    const void* jobArg = nullptr;
+    int jobId = 0, running = 0;
+    bool quit = false;
+
+    void loop(int id, int seen) {
+        for (;;) {
+            unique_lock<mutex> lock(m);
+            wake.wait(lock, [&]{ return quit || jobId != seen; });
+            if (quit) return;
+            seen = jobId;
+            lock.unlock();
+            job(jobArg, id);
+            lock.lock();
+            if (--running == 0) finished.notify_all();
+        }
+    }
+
+    void stop() {
+        { lock_guard<mutex> lock(m); quit = true; }
+        wake.notify_all();
+        for (auto &t : helpers) t.join();
+        helpers.clear();
+        quit = false;
+    }
+
+public:
+    ~SearchPool() { stop(); }
+
+    int threads() const { return (int)helpers.size() + 1; }
+
+    void resize(int threadCount) {
+        if (threadCount == threads()) return;
+        stop();
+        for (int i=1;i<threadCount;i++) helpers.emplace_back(&SearchPool::loop, this, i, jobId);
+    }
+
+    template <class F>
+    void run(const F &f) {
+        {
+            lock_guard<mutex> lock(m);
+            job = [](const void* arg, int id) { (*(const F*)arg)(id); };
+            jobArg = &f;
+            running = (int)helpers.size();
+            ++jobId;
+        }
+        wake.notify_all();
+        f(0);
+        unique_lock<mutex> lock(m);
+        finished.wait(lock, [&]{ return running == 0; });
+    }
+};
+
+inline int searchThreads = max(1u, thread::hardware_concurrency());   // --threads
+inline SearchPool searchPool;
+
+// The root is split one ply deeper: every (root move, reply) pair is a task.
+// Tasks are dealt round-robin to per-worker queues in root order; a worker
+// takes from the front of its own queue and steals from the back of the others.
+//
+// Workers share the transposition table and two kinds of bounds: alpha, the
+// best exact root value so far (with the cell that reached it), and for each
+// root move the lowest exact reply value so far (its beta). As in the serial
+// search, a root cell below the best one only has to tie alpha and any other
+// must beat it; a reply that fails low against that proves its root move can't
+// be chosen, so the rest of that root's replies are skipped. Every root move
+// that is not eliminated ends with an exact value; the best one, lowest cell
+// on ties, is the same move the serial Searcher returns.
+struct ParallelRoot {
+    int cell;
+    int value;
+    atomic<int> beta{numeric_limits<int>::max()};
+    atomic<int> pending{0};
+    atomic<bool> eliminated{false};
+    atomic<bool> resolved{false};   // value is final
+};
+
+struct ReplyTask { int root, reply; };
+
+struct TaskQueue {
+    mutex m;
+    vector<ReplyTask> tasks;   // the front is tasks[head]
+    size_t head = 0;
+
+    bool empty() const { return head == tasks.size(); }
+};
+
+// Storage for parallelFindBestMove kept from one search to the next, so a
+// search allocates nothing once the first one has sized it.
+struct ParallelScratch {
+    unique_ptr<ParallelRoot[]> roots{new ParallelRoot[MAX_CELLS]};
+    unique_ptr<TaskQueue[]> queues;
+    int queueCount = 0;
+    vector<SearchResult> perThread;
+    vector<SearchStats> perThreadStats;   // sized only when the caller wants stats
+
+    void prepare(int threadCount, int rootCount) {
+        for (int i=0;i<rootCount;i++) {
+            roots[i].beta = numeric_limits<int>::max();
+            roots[i].pending = 0;
+            roots[i].eliminated = false;
+            roots[i].resolved = false;
+        }
+        if (queueCount < threadCount) {
+            queues.reset(new TaskQueue[threadCount]);
+            queueCount = threadCount;
+        }
+        for (int t=0;t<threadCount;t++) { queues[t].tasks.clear(); queues[t].head = 0; }
+        perThread.assign(threadCount, SearchResult{-1, 0, 0, 0, 0, 0});
+        if (perThreadStats.size() < (size_t)threadCount) perThreadStats.resize(threadCount);
+    }
+};
+inline ParallelScratch parallelScratch;   // parallelFindBestMove is not reentrant anyway: it owns searchPool
+
+// Like Searcher::findBestMove this searches to maxDepth with firstMove ahead of
+// the other root moves, and on running out of budget it still answers if that
+// first root move was finished.
+inline SearchResult parallelFindBestMove(const Position &rootPos, int threadCount, SearchControl* control = nullptr,
+                                  int maxDepth = MAX_CELLS, int firstMove = -1) {
+    searchPool.resize(threadCount);
+    Searcher planner(rootPos);
+    int moves[MAX_CELLS];
+    int count = planner.rootMoves(moves, firstMove);
+    SearchResult r = {-1, numeric_limits<int>::min(), 0, 0, 0, 0};
+    if (count == 0) return r;
+
+    ParallelScratch &scratch = parallelScratch;
+    scratch.prepare(threadCount, count);
+    ParallelRoot* roots = scratch.roots.get();
+    TaskQueue* queues = scratch.queues.get();
+    // Best (value, cell) so far packed so that a larger number is a better root move
+    const long long NO_ALPHA = numeric_limits<long long>::min();
+    atomic<long long> alpha{NO_ALPHA};
+    auto pack = [](int value, int cell) { return (long long)value * 256 + (255 - cell); };
+    auto raiseAlpha = [&](int value, int cell) {
+        long long v = pack(value, cell), cur = alpha.load();
+        while (v > cur && !alpha.compare_exchange_weak(cur, v)) {}
+    };
+
+    // Root moves that end the game, or allow an immediate reply win, are scored here.
+    int dealt = 0;
+    for (int i=0;i<count;i++) {
+        ParallelRoot &root = roots[i];
+        root.cell = moves[i];
+        Position &p = planner.pos;
+        p.makeMove(root.cell, 2);
+        if (p.hasWon(2) || p.isFull()) {
+            root.value = planner.evaluate(0);
+            root.resolved = true;
+            raiseAlpha(root.value, root.cell);
+        } else if (p.winningCells(1)) {
+            root.value = -WIN_SCORE + 1;
+            root.resolved = true;
+            raiseAlpha(root.value, root.cell);
+        } else {
+            int replies[MAX_CELLS];
+            int replyCount = planner.orderMoves(planner.candidateMoves(1), 1, 0, -1, replies);
+            root.pending = replyCount;
+            for (int j=0;j<replyCount;j++)
+                queues[dealt++ % threadCount].tasks.push_back(ReplyTask{i, replies[j]});
+        }
+        p.unmakeMove(root.cell, 2);
+    }
+
+    vector<SearchResult> &perThread = scratch.perThread;
+    atomic<bool> aborted{false};
+    searchPool.run([&](int id) {
+        Searcher s(rootPos, control);
+        s.maxDepth = maxDepth;
+        if (s.stats) { s.stats = &scratch.perThreadStats[id]; s.stats->clear(); }
+        while (!s.aborted) {
+            ReplyTask task;
+            bool found = false;
+            for (int k=0;k<threadCount && !found;k++) {
+                TaskQueue &q = queues[(id + k) % threadCount];
+                lock_guard<mutex> lock(q.m);
+                if (q.empty()) continue;
+                if (k == 0) { task = q.tasks[q.head++]; }
+                else        { task = q.tasks.back(); q.tasks.pop_back(); }
+                found = true;
+            }
+            if (!found) break;
+
+            ParallelRoot &root = roots[task.root];
+            long long a = alpha.load();
+            int lo = numeric_limits<int>::min();
+            if (a != NO_ALPHA) {
+                int bestValue = (int)((a - (a & 255)) / 256), bestCell = 255 - (int)(a & 255);
+                lo = root.cell < bestCell ? bestValue - 1 : bestValue;
+            }
+            int hi = root.beta.load();
+            if (!root.eliminated && lo >= hi) root.eliminated = true;
+            if (!root.eliminated) {
+                s.pos.makeMove(root.cell, 2);
+                s.pos.makeMove(task.reply, 1);
+                int val = s.minimaxAB(true, 1, lo, hi);
+                s.pos.unmakeMove(task.reply, 1);
+                s.pos.unmakeMove(root.cell, 2);
+                if (s.aborted) { aborted = true; break; }
+                if (val <= lo) {
+                    root.eliminated = true;
+                } else if (val < hi) {
+                    int cur = root.beta.load();
+                    while (val < cur && !root.beta.compare_exchange_weak(cur, val)) {}
+                }
+            }
+            if (--root.pending == 0 && !root.eliminated) {
+                root.value = root.beta.load();
+                root.resolved = true;
+                raiseAlpha(root.value, root.cell);
+            }
+        }
+        perThread[id].nodes = s.nodes;
+        perThread[id].ttHits = s.ttHits;
+        perThread[id].ttMisses = s.ttMisses;
+    });
+
+    bool usable = !aborted || firstMove < 0 || roots[0].resolved;
+    for (int i=0;i<count && usable;i++) {
+        const ParallelRoot &root = roots[i];
+        if (root.eliminated || !root.resolved) continue;
+        if (r.cell < 0 || root.value > r.value || (root.value == r.value && root.cell < r.cell)) {
+            r.value = root.value;
+            r.cell = root.cell;
+        }
+    }
+    r.depth = aborted ? 0 : min(maxDepth + 1, rootPos.emptyCount);
+    for (int i=0;i<threadCount;i++) {
+        const SearchResult &t = perThread[i];
+        r.nodes += t.nodes;
+        r.ttHits += t.ttHits;
+        r.ttMisses += t.ttMisses;
+        if (control && control->stats) control->stats->add(scratch.perThreadStats[i]);
+    }
+    return r;
+}
+
+
+// Best move for either player at a fixed depth with the serial search; X
+// searches the colour-swapped board. The value is from the mover's point of view.
+inline SearchResult findBestMoveFor(const Position &pos, int player, int maxDepth = MAX_CELLS) {
+    return withSearcher(player == 2 ? pos : pos.swapped(), nullptr, [&](auto &s) {
+        s.maxDepth = maxDepth;
+        return s.findBestMove();
+    });
+}
+
+// Best move for the computer (player 2) in pos by search, serial or parallel per
+// --threads; serial passes run on the fixed-size engine when one covers the
+// board. With a time or node budget this deepens iteratively: each pass
+// searches one ply deeper, starting with the previous pass's choice, until the
+// game is solved or the budget runs out; then the deepest usable answer is
+// returned. Without a budget it solves the position in a single pass. Returns
+// cell -1 if the board is full or control->stop was raised.
+inline SearchResult searchPosition(const Position &pos, SearchControl* control = nullptr) {
+    transTable.newSearch();
+    return withSearcher(pos, control, [&](auto &serial) {
+        SearchResult best = {-1, 0, 0, 0, 0, 0};
+        bool budgeted = control && (control->timeLimit > 0 || control->nodeLimit > 0);
+        for (int maxDepth = budgeted ? 0 : pos.emptyCount - 1; maxDepth < pos.emptyCount; maxDepth++) {
+            SearchResult r;
+            // a one-ply pass has no replies to split
+            if (searchThreads > 1 && maxDepth > 0) {
+                r = parallelFindBestMove(pos, searchThreads, control, maxDepth, best.cell);
+            } else {
+                serial.maxDepth = maxDepth;
+                r = serial.findBestMove(best.cell);
+            }
+            best.nodes += r.nodes;
+            best.ttHits += r.ttHits;
+            best.ttMisses += r.ttMisses;
+            if (r.cell >= 0) {
+                best.cell = r.cell;
+                best.value = r.value;
+            }
+            if (r.depth == 0) break;   // out of budget
+            best.depth = r.depth;
+            best.finishedCell = best.cell;
+            best.finishedValue = best.value;
+            if (isWinScore(best.value)) break;   // forced result; deeper passes can't change it
+        }
+        if (control && control->stop) best.cell = -1;
+        return best;
+    });
+}
+
@@ -0,0 +1,80 @@
+// File: engine/searchlog.h
+// One record per computer move with the search counters, for plotting and
+// comparing engine changes: JSON Lines for a .json/.jsonl path, CSV otherwise.
+//   SearchLog log; log.open("moves.csv");
+//   log.write(pos, result, stats);   // pos is the board the move was chosen on
+#pragma once
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "board.h"
+#include "search.h"
+
+using namespace std;
+
+// ---------- Search log ----------
+class SearchLog {
+private:
+    FILE* f = nullptr;
+    bool json = false;
+    int moves = 0;
+
+    static bool endsWith(const string &s, const char* suffix) {
+        size_t n = strlen(suffix);
+        return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+    }
+
+public:
+    SearchLog() = default;
+    SearchLog(const SearchLog&) = delete;
+    SearchLog& operator=(const SearchLog&) = delete;
+    ~SearchLog() { close(); }
+
+    bool isOpen() const { return f != nullptr; }
+
+    // Truncates path; false if it cannot be created
+    bool open(const string &path) {
+        close();
+        f = fopen(path.c_str(), "w");
+        if (!f) return false;
+        json = endsWith(path, ".json") || endsWith(path, ".jsonl");
+        moves = 0;
+        if (!json)
+            fprintf(f, "move,rows,cols,k,empty,cell,value,depth,seconds,nodes,nodes_per_sec,"
+                       "tt_hits,tt_misses,interior,branching,cutoffs,first_move_cutoffs,cutoffs_by_ply\n");
+        return true;
+    }
+
+    void close() {
+        if (f) fclose(f);
+        f = nullptr;
+    }
+
+    // Cutoffs by ply run from ply 1 up to the deepest ply that had one
+    void write(const Position &pos, const SearchResult &r, const SearchStats &s) {
+        if (!f) return;
+        const double rate = r.seconds > 0 ? r.nodes / r.seconds : 0;
+        const int plies = s.deepestCutoff();
+        if (json) {
+            fprintf(f, "{\"move\":%d,\"rows\":%d,\"cols\":%d,\"k\":%d,\"empty\":%d,\"cell\":%d,\"value\":%d,"
+                       "\"depth\":%d,\"seconds\":%.6f,\"nodes\":%lld,\"nodes_per_sec\":%.0f,"
+                       "\"tt_hits\":%lld,\"tt_misses\":%lld,\"interior\":%lld,\"branching\":%.3f,"
+                       "\"cutoffs\":%lld,\"first_move_cutoffs\":%lld,\"cutoffs_by_ply\":[",
+                    ++moves, pos.rows, pos.cols, pos.k, pos.emptyCount, r.cell, r.value,
+                    r.depth, r.seconds, r.nodes, rate, r.ttHits, r.ttMisses, s.interior, s.branching(),
+                    s.totalCutoffs(), s.firstMoveCutoffs);
+            for (int p=1;p<=plies;p++) fprintf(f, p > 1 ? ",%lld" : "%lld", s.cutoffs[p]);
+            fprintf(f, "]}\n");
+        } else {
+            fprintf(f, "%d,%d,%d,%d,%d,%d,%d,%d,%.6f,%lld,%.0f,%lld,%lld,%lld,%.3f,%lld,%lld,",
+                    ++moves, pos.rows, pos.cols, pos.k, pos.emptyCount, r.cell, r.value,
+                    r.depth, r.seconds, r.nodes, rate, r.ttHits, r.ttMisses, s.interior, s.branching(),
+                    s.totalCutoffs(), s.firstMoveCutoffs);
+            for (int p=1;p<=plies;p++) fprintf(f, p > 1 ? ";%lld" : "%lld", s.cutoffs[p]);
+            fprintf(f, "\n");
+        }
+        fflush(f);   // a game can end with the window closed
+    }
+};
@@ -0,0 +1,100 @@
+// File: engine/transposition.h
+// Lock-free transposition table shared by all search threads.
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+using namespace std;
+
+// ---------- Transposition table ----------
+// Two-entry buckets: slot 0 keeps the deepest result of the current search
+// generation, slot 1 always takes the newest store.
+// Search threads share the table without locks: each slot stores key ^ data
+// next to data, so a slot torn by a concurrent write fails the key check
+// instead of returning another position's result.
+enum Bound { BOUND_NONE, BOUND_EXACT, BOUND_LOWER, BOUND_UPPER };
+const int NO_MOVE = 255;
+
+struct TTSlot {
+    atomic<unsigned long long> check;   // key ^ data
+    atomic<unsigned long long> data;    // value:16 | depth:8 | bound:8 | move:8 | generation:8
+};
+
+class TranspositionTable {
+private:
+    unique_ptr<TTSlot[]> slots;
+    size_t slotCount;
+    size_t bucketMask;
+    atomic<unsigned char> generation;   // searches may start concurrently, e.g. one per server worker
+
+    static unsigned long long pack(int value, int depth, int bound, int move, int gen) {
+        return (unsigned long long)(unsigned short)value
+             | (unsigned long long)depth << 16
+             | (unsigned long long)bound << 24
+             | (unsigned long long)move << 32
+             | (unsigned long long)gen << 40;
+    }
+    static int depthOf(unsigned long long d) { return (int)((d >> 16) & 0xFF); }
+    static int genOf(unsigned long long d)   { return (int)((d >> 40) & 0xFF); }
+
+    static void write(TTSlot &slot, unsigned long long key, unsigned long long data) {
+        slot.check.store(key ^ data, memory_order_relaxed);
+        slot.data.store(data, memory_order_relaxed);
+    }
+
+public:
+    explicit TranspositionTable(size_t megabytes) { resize(megabytes); }
+
+    // Rounds the budget down to a power-of-two number of buckets (at least one).
+    void resize(size_t megabytes) {
+        size_t buckets = 1;
+        while (buckets * 2 * 2 * sizeof(TTSlot) <= megabytes * 1024 * 1024) buckets *= 2;
+        slotCount = buckets * 2;
+        slots.reset(new TTSlot[slotCount]);
+        bucketMask = buckets - 1;
+        clear();
+    }
+
+    void clear() {
+        for (size_t i=0;i<slotCount;i++) write(slots[i], 0, 0);
+        generation.store(0, memory_order_relaxed);
+    }
+
+    void newSearch() { generation.fetch_add(1, memory_order_relaxed); }
+    size_t sizeBytes() const { return slotCount * sizeof(TTSlot); }
+
+    bool probe(unsigned long long key, int &value, int &depth, int &bound, int &move) const {
+        const TTSlot* b = &slots[(key & bucketMask) * 2];
+        for (int i=0;i<2;i++){
+            unsigned long long d = b[i].data.load(memory_order_relaxed);
+            if (d != 0 && (b[i].check.load(memory_order_relaxed) ^ d) == key) {
+                value = (short)(d & 0xFFFF);
+                depth = depthOf(d);
+                bound = (int)((d >> 24) & 0xFF);
+                move  = (int)((d >> 32) & 0xFF);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void store(unsigned long long key, int value, int depth, int bound, int move) {
+        TTSlot* b = &slots[(key & bucketMask) * 2];
+        const int gen = generation.load(memory_order_relaxed);
+        unsigned long long data = pack(value, depth, bound, move, gen);
+        unsigned long long d0 = b[0].data.load(memory_order_relaxed);
+        unsigned long long k0 = b[0].check.load(memory_order_relaxed) ^ d0;
+        if (k0 == key || d0 == 0 || genOf(d0) != gen || depth >= depthOf(d0)) {
+            if (k0 != key && d0 != 0) write(b[1], k0, d0);   // demote, don't drop
+            write(b[0], key, data);
+        } else {
+            write(b[1], key, data);
+        }
+    }
+};
+
+// Shared by every game; sized with --tt-mb
+inline TranspositionTable transTable(16);
+
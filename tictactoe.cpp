@@ -1,6 +1,22 @@
 // File: tictactoe.cpp
 // Compile (example, on Windows with MinGW + freeglut):
-// g++ tictactoe.cpp -o tictactoe.exe -lfreeglut -lopengl32 -lglu32
+// g++ -O2 tictactoe.cpp -o tictactoe.exe -lfreeglut -lopengl32 -lglu32 -pthread
+// The engine lives in engine/ (no GL); CMakeLists.txt builds it, this GUI and the
+// headless benchmark: cmake -S . -B build && cmake --build build && build/tictactoe-bench
+// Benchmark suite with JSON results in build/bench-results: cmake --build build --target bench
+// Transposition table budget (default 16 MB): tictactoe.exe --tt-mb 64
+// Search threads (default: all hardware threads): tictactoe.exe --threads 4
+// Computer's time per move (default 1000 ms): tictactoe.exe --move-ms 500
+// Computer engine for "Player1 VS Computer" (default minimax): tictactoe.exe --engine mcts
+// Fixed MCTS playouts per move instead of the time budget: tictactoe.exe --playouts 50000
+// Nodes of the df-pn forced-win check before each search, apart from its budget (default 20000, 0 = off): --proof-nodes 100000
+// Build the 3x3/4x4 opening book (default tictactoe.book): tictactoe.exe --gen-book
+// Use a book from elsewhere (tictactoe.book is loaded if present): tictactoe.exe --book path
+// Print frames per second, draw time and CPU use every second: tictactoe.exe --frame-stats
+// Show the computer's search counters on the board: tictactoe.exe --search-stats
+// Log them per computer move, CSV or JSON Lines by extension: tictactoe.exe --search-log moves.csv
+// Every game is appended to tictactoe.games (read it with tictactoe-records): --record path, --no-record
+// Searched moves are kept in tictactoe.cache for later sessions (created at 4 MB): --cache path, --cache-mb 16, --no-cache
 
 /*echo "# TicTacToe" >> README.md
 git init
@@ -11,12 +27,19 @@ git remote add origin https://github.com/Shajia-Tabassum-Orthe/TicTacToe.git
 git push -u origin main*/
 
 #include <GL/freeglut.h>
+#include <GL/glext.h>
 #include <iostream>
 #include <vector>
 #include <ctime>
 #include <cmath>
-#include <limits>
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <atomic>
+#include <thread>
+
+#include "engine/engine.h"
 
 using namespace std;
 
@@ -30,181 +53,493 @@ enum MenuStep { MODE_SELECT, SIZE_SELECT };
 enum Mode { MODE_NONE, HUMAN_VS_COMPUTER, HUMAN_VS_HUMAN };
 MenuStep menuStep = MODE_SELECT;
 Mode selectedMode = MODE_NONE;
-int selectedSize = 0; // 3 or 4
+int selectedSize = 0; // 3 .. GUI_MAX_N, or GOMOKU_N
+const int GUI_MAX_N = 10;               // largest n x n board (n in a row) in the size menu
+const int GOMOKU_N = 15, GOMOKU_K = 5;  // plus Gomoku: 15 x 15, five in a row
 
 enum AppState { STATE_MENU, STATE_PLAY };
 AppState appState = STATE_MENU;
 
+// ---------- Vertex buffers ----------
+// Geometry that only changes with the board size, the window size or a move is
+// built once into a buffer object and drawn with one glDrawArrays per batch.
+// Buffer objects are GL 1.5 and opengl32.dll only exports GL 1.1, so the entry
+// points are looked up at run time; without them a batch is drawn from client
+// memory, still in a single call.
+struct BufferFunctions {
+    PFNGLGENBUFFERSPROC genBuffers = nullptr;
+    PFNGLDELETEBUFFERSPROC deleteBuffers = nullptr;
+    PFNGLBINDBUFFERPROC bindBuffer = nullptr;
+    PFNGLBUFFERDATAPROC bufferData = nullptr;
+    bool contextLive = false;   // false once the window closes: its context takes the buffers with it
+
+    bool available() const { return genBuffers && deleteBuffers && bindBuffer && bufferData; }
+};
+BufferFunctions glBuffers;
+
+// Needs a current context: call after glutCreateWindow
+void loadBufferFunctions() {
+    glBuffers.genBuffers = (PFNGLGENBUFFERSPROC)glutGetProcAddress("glGenBuffers");
+    glBuffers.deleteBuffers = (PFNGLDELETEBUFFERSPROC)glutGetProcAddress("glDeleteBuffers");
+    glBuffers.bindBuffer = (PFNGLBINDBUFFERPROC)glutGetProcAddress("glBindBuffer");
+    glBuffers.bufferData = (PFNGLBUFFERDATAPROC)glutGetProcAddress("glBufferData");
+    glBuffers.contextLive = true;
+}
+
+// Coloured (optionally textured) vertices of one primitive type. Fill it after
+// clear(), then draw() uploads it on first use and after every rebuild.
+class VertexBatch {
+private:
+    GLenum mode;
+    bool textured;
+    vector<float> data;   // x, y, r, g, b [, s, t] per vertex
+    float r = 0, g = 0, b = 0, s = 0, t = 0;
+    GLuint vbo = 0;
+    bool uploaded = false;
+
+    int floatsPerVertex() const { return textured ? 7 : 5; }
+
+public:
+    explicit VertexBatch(GLenum primitive, bool withTexCoords = false) : mode(primitive), textured(withTexCoords) {}
+    ~VertexBatch() { if (vbo && glBuffers.contextLive) glBuffers.deleteBuffers(1, &vbo); }   // static batches outlive the window
+    VertexBatch(const VertexBatch&) = delete;
+    VertexBatch& operator=(const VertexBatch&) = delete;
+
+    void clear() { data.clear(); uploaded = false; }
+    bool empty() const { return data.empty(); }
+    void color(float red, float green, float blue) { r = red; g = green; b = blue; }
+    void texCoord(float u, float v) { s = u; t = v; }
+    void vertex(float x, float y) {
+        float v[7] = {x, y, r, g, b, s, t};
+        data.insert(data.end(), v, v + floatsPerVertex());
+    }
+
+    // Textured batches sample whatever texture the caller has bound
+    void draw(float lineWidth = 1) {
+        if (data.empty()) return;
+        const GLsizei stride = floatsPerVertex() * sizeof(float);
+        const char* base = (const char*)data.data();
+        if (glBuffers.available()) {
+            if (!vbo) glBuffers.genBuffers(1, &vbo);
+            glBuffers.bindBuffer(GL_ARRAY_BUFFER, vbo);
+            if (!uploaded) glBuffers.bufferData(GL_ARRAY_BUFFER, data.size() * sizeof(float), data.data(), GL_STATIC_DRAW);
+            base = nullptr;   // offsets into the bound buffer
+        }
+        uploaded = true;
+        glLineWidth(lineWidth);
+        glEnableClientState(GL_VERTEX_ARRAY);
+        glEnableClientState(GL_COLOR_ARRAY);
+        glVertexPointer(2, GL_FLOAT, stride, base);
+        glColorPointer(3, GL_FLOAT, stride, base + 2 * sizeof(float));
+        if (textured) {
+            glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+            glTexCoordPointer(2, GL_FLOAT, stride, base + 5 * sizeof(float));
+        }
+        glDrawArrays(mode, 0, (GLsizei)(data.size() / floatsPerVertex()));
+        if (textured) glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+        glDisableClientState(GL_COLOR_ARRAY);
+        glDisableClientState(GL_VERTEX_ARRAY);
+        if (glBuffers.available()) glBuffers.bindBuffer(GL_ARRAY_BUFFER, 0);
+        glLineWidth(1);
+    }
+};
+
+// ---------- Text ----------
+// GLUT_BITMAP_HELVETICA_18 is rasterised once into an alpha texture, one
+// GLYPH_CELL square per printable character, by drawing it with
+// glutBitmapCharacter and reading it back. A string is then a batch of
+// textured quads on the same pixels glutBitmapCharacter would have set, and a
+// TextLabel keeps that batch until its text, position or colour changes.
+const int GLYPH_CELL = 32;        // px per glyph, with the pen origin GLYPH_PAD in from the lower left
+const int GLYPH_PAD = 8;
+const int GLYPH_COLUMNS = 16;
+const int GLYPH_FIRST = 32, GLYPH_LAST = 126;
+const int ATLAS_W = 512, ATLAS_H = 256;
+
+class GlyphAtlas {
+private:
+    GLuint texture = 0;
+    int advance[GLYPH_LAST + 1] = {};
+
+public:
+    bool ready() const { return texture != 0; }
+
+    // Draws into the back buffer, so call it at the start of a frame, before
+    // the clear. Returns false (try again later) while the window is too small.
+    bool build(int winW, int winH) {
+        const int rows = (GLYPH_LAST - GLYPH_FIRST) / GLYPH_COLUMNS + 1;
+        const int usedW = GLYPH_COLUMNS * GLYPH_CELL, usedH = rows * GLYPH_CELL;
+        if (winW < usedW || winH < usedH) return false;
+        glClearColor(0,0,0,1);
+        glClear(GL_COLOR_BUFFER_BIT);
+        glColor3f(1,1,1);
+        for (int c=GLYPH_FIRST; c<=GLYPH_LAST; c++) {
+            int k = c - GLYPH_FIRST;
+            glRasterPos2i((k % GLYPH_COLUMNS) * GLYPH_CELL + GLYPH_PAD, (k / GLYPH_COLUMNS) * GLYPH_CELL + GLYPH_PAD);
+            glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, c);
+            advance[c] = glutBitmapWidth(GLUT_BITMAP_HELVETICA_18, c);
+        }
+        vector<unsigned char> pixels(ATLAS_W * ATLAS_H, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glPixelStorei(GL_PACK_ROW_LENGTH, ATLAS_W);
+        glReadPixels(0, 0, usedW, usedH, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+        glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+        glClearColor(1,1,1,1);
+        glGenTextures(1, &texture);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_ALPHA, ATLAS_W, ATLAS_H, 0, GL_ALPHA, GL_UNSIGNED_BYTE, pixels.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+        return true;
+    }
+
+    // Appends the quads of text with its pen starting at (x, y), like glRasterPos2f
+    void layout(VertexBatch &batch, float x, float y, const char* text) const {
+        float penX = floorf(x), penY = floorf(y);
+        for (const char* p = text; *p; ++p) {
+            int c = (unsigned char)*p;
+            if (c < GLYPH_FIRST || c > GLYPH_LAST) continue;
+            int k = c - GLYPH_FIRST;
+            float u0 = (float)(k % GLYPH_COLUMNS) * GLYPH_CELL / ATLAS_W, v0 = (float)(k / GLYPH_COLUMNS) * GLYPH_CELL / ATLAS_H;
+            float u1 = u0 + (float)GLYPH_CELL / ATLAS_W, v1 = v0 + (float)GLYPH_CELL / ATLAS_H;
+            float x0 = penX - GLYPH_PAD, y0 = penY - GLYPH_PAD;
+            batch.texCoord(u0, v0); batch.vertex(x0, y0);
+            batch.texCoord(u1, v0); batch.vertex(x0 + GLYPH_CELL, y0);
+            batch.texCoord(u1, v1); batch.vertex(x0 + GLYPH_CELL, y0 + GLYPH_CELL);
+            batch.texCoord(u0, v1); batch.vertex(x0, y0 + GLYPH_CELL);
+            penX += advance[c];
+        }
+    }
+
+    // Glyph texels are 0 or 255: the alpha test keeps exactly the bitmap's pixels
+    void draw(VertexBatch &batch) const {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glEnable(GL_TEXTURE_2D);
+        glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+        glEnable(GL_ALPHA_TEST);
+        glAlphaFunc(GL_GREATER, 0.5f);
+        batch.draw();
+        glDisable(GL_ALPHA_TEST);
+        glDisable(GL_TEXTURE_2D);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+};
+GlyphAtlas glyphAtlas;
+
+// Per-character fallback for when the atlas isn't built yet
+void drawBitmapText(float x, float y, const char* text) {
+    glRasterPos2f(x, y);
+    for (const char* c = text; *c; ++c) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+}
+
+// One string on screen; its quads are rebuilt only when something about it changes
+class TextLabel {
+private:
+    VertexBatch glyphs{GL_QUADS, true};
+    string text;
+    float x = 0, y = 0, r = 0, g = 0, b = 0;
+    bool built = false;
+
+public:
+    void draw(float px, float py, const char* str, float red=0, float green=0, float blue=0) {
+        if (!glyphAtlas.ready()) {
+            glColor3f(red, green, blue);
+            drawBitmapText(px, py, str);
+            return;
+        }
+        if (!built || px != x || py != y || red != r || green != g || blue != b || text != str) {
+            text = str; x = px; y = py; r = red; g = green; b = blue;
+            glyphs.clear();
+            glyphs.color(r, g, b);
+            glyphAtlas.layout(glyphs, x, y, str);
+            built = true;
+        }
+        glyphAtlas.draw(glyphs);
+    }
+};
+
+// Unit circle for the O mark, as the 100 segments the old line loop used
+struct CircleTemplate {
+    float x[101], y[101];
+    CircleTemplate() {
+        for (int k=0;k<=100;k++) {
+            float a = 2*3.1415926f*k/100.0f;
+            x[k] = cos(a);
+            y[k] = sin(a);
+        }
+    }
+};
+const CircleTemplate unitCircle;
+
+// ---------- Frame scheduler ----------
+// Nothing redraws on its own: a frame is drawn when input, a resize, the
+// computer's move or its progress, or a running animation asks for one. An
+// animation asks through requestAnimationFrame, which paces frames FRAME_MS
+// apart from the start of the previous one (swap interval 1 caps them at the
+// display rate too), so an idle window costs no CPU at all.
+const int FRAME_MS = 16;   // about 60 Hz while animating
+chrono::steady_clock::time_point frameStart;
+bool animationFramePending = false;
+
+struct FrameStats {
+    long long frames = 0;
+    double drawSec = 0;   // inside the display callback
+};
+FrameStats frameStats;
+bool showFrameStats = false;   // --frame-stats
+
+// ---------- Search counters ----------
+// Collected only when asked for; otherwise the search skips them.
+bool showSearchStats = false;  // --search-stats: overlay in the game view
+SearchLog searchLog;           // --search-log: one record per computer move
+bool wantSearchStats() { return showSearchStats || searchLog.isOpen(); }
+
+void animationTick(int){
+    animationFramePending = false;
+    glutPostRedisplay();
+}
+
+void requestAnimationFrame(){
+    if(animationFramePending) return;
+    animationFramePending = true;
+    int spent = (int)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - frameStart).count();
+    glutTimerFunc(max(1, FRAME_MS - spent), animationTick, 0);
+}
+
+// Swap interval 1 where the platform offers it (WGL_EXT_swap_control, GLX_SGI/MESA_swap_control)
+void enableVsync(){
+    typedef int (APIENTRY *SwapIntervalFn)(int);
+    const char* names[] = {"wglSwapIntervalEXT", "glXSwapIntervalSGI", "glXSwapIntervalMESA"};
+    for(const char* name : names){
+        SwapIntervalFn f = (SwapIntervalFn)glutGetProcAddress(name);
+        if(f){ f(1); return; }
+    }
+}
+
+// --frame-stats: once a second, frames drawn, draw time and process CPU use
+void reportFrameStats(int){
+    static long long lastFrames = 0;
+    static double lastDraw = 0;
+    static clock_t lastCpu = clock();
+    static chrono::steady_clock::time_point lastWall = chrono::steady_clock::now();
+    chrono::steady_clock::time_point wall = chrono::steady_clock::now();
+    clock_t cpu = clock();
+    double sec = chrono::duration<double>(wall - lastWall).count();
+    long long frames = frameStats.frames - lastFrames;
+    printf("fps=%5.1f  draw=%6.2f ms/frame  cpu=%5.1f%%\n", frames / sec,
+           frames ? (frameStats.drawSec - lastDraw) * 1000 / frames : 0.0,
+           100.0 * (cpu - lastCpu) / CLOCKS_PER_SEC / sec);
+    fflush(stdout);
+    lastFrames = frameStats.frames;
+    lastDraw = frameStats.drawSec;
+    lastCpu = cpu;
+    lastWall = wall;
+    glutTimerFunc(1000, reportFrameStats, 0);
+}
+
+// ---------- Animation ----------
+// A new mark grows in over MARK_GROW_SEC of steady-clock time, eased out, so
+// the speed doesn't depend on the frame rate. Only cells still growing are
+// kept, and with none left an update does nothing.
+const double MARK_GROW_SEC = 0.35;
+
+inline float easeOutCubic(float t) {
+    t = 1 - t;
+    return 1 - t*t*t;
+}
+
+class Animator {
+private:
+    struct Growing {
+        int cell;
+        chrono::steady_clock::time_point start;
+    };
+    vector<Growing> growing;
+
+public:
+    void start(int cell) { growing.push_back({cell, chrono::steady_clock::now()}); }
+    void clear() { growing.clear(); }
+    bool running() const { return !growing.empty(); }
+
+    // Calls set(cell, scale) for every growing cell at the current time;
+    // cells that reach full size are dropped after their last update.
+    template<class SetScale>
+    void update(SetScale set) {
+        chrono::steady_clock::time_point now = chrono::steady_clock::now();
+        size_t kept = 0;
+        for (size_t k=0;k<growing.size();k++) {
+            float t = (float)(chrono::duration<double>(now - growing[k].start).count() / MARK_GROW_SEC);
+            set(growing[k].cell, t >= 1 ? 1.0f : easeOutCubic(t));
+            if (t < 1) growing[kept++] = growing[k];
+        }
+        growing.resize(kept);
+    }
+};
+
+// ---------- Game archive ----------
+GameRecordWriter gameArchive;   // opened in main unless --no-record
+
+// Writes the games still buffered when the program ends
+void closeArchive() {
+    if(!gameArchive.close()) printf("Could not write every game to the game archive (disk full?)\n");
+}
+
 // ---------- TicTacToe Class ----------
 class TicTacToe {
 private:
     int n;
-    int** board;         // 0 empty, 1 = X (player1), 2 = O (player2 or computer)
-    float** anim;        // animation scale for each cell (0..1)
-    int currentPlayer;   // 1 or 2; X always starts
-    bool gameOver;
-    int winner;          // 0 draw/none, 1 X, 2 O
+    int inRow;           // marks in a row to win
+    Game match;          // board and rules, from the engine
+    alignas(64) float anim[MAX_CELLS];   // animation scale for each cell (0..1), row-major
+    Animator animator;   // cells whose mark is still growing
     int scoreX, scoreO;
+    SearchResult lastSearch;   // stats of the last findBestMove
+    SearchStats lastCounters;  // counters of the last background search, if collected
+    GameRecord record;         // moves of the game on the board, for gameArchive
+    RecordMode recordMode = RECORD_UNKNOWN;
+
+    // Cached geometry: the grid for the viewport it was built for, the marks
+    // until a move, a restart or an animation step changes them
+    VertexBatch cellQuads{GL_QUADS}, gridLines{GL_LINES}, border{GL_LINES}, markLines{GL_LINES};
+    float gridX = -1, gridY = -1, gridCell = -1;
+    bool marksDirty = true;
+    TextLabel nameText, rollText, scoreText, resultText, hintText, statsText, cutoffText;
 
 public:
-    TicTacToe(int size) : n(size) {
-        board = new int*[n];
-        anim = new float*[n];
-        for (int i=0;i<n;i++){
-            board[i] = new int[n];
-            anim[i] = new float[n];
-        }
+    TicTacToe() { start(3, 3); }
+
+    // New match on an n x n board, k in a row, scores from zero. The object
+    // (and its buffers) is reused from game to game, so this allocates nothing.
+    void start(int size, int k){
+        n = size;
+        inRow = k;
+        gridX = gridY = gridCell = -1;
         resetBoard();
         scoreX = scoreO = 0;
-    }
-
-    ~TicTacToe(){
-        for (int i=0;i<n;i++){
-            delete[] board[i];
-            delete[] anim[i];
-        }
-        delete[] board;
-        delete[] anim;
+        lastSearch = SearchResult{-1, 0, 0, 0, 0, 0};
+        lastCounters.clear();
     }
 
     void resetBoard(){
-        for (int i=0;i<n;i++)
-            for (int j=0;j<n;j++){
-                board[i][j] = 0;
-                anim[i][j] = 0.0f;
-            }
-        currentPlayer = 1;
-        gameOver = false;
-        winner = 0;
+        saveRecord();
+        match.reset(n, n, inRow);
+        record.start(n, n, inRow, recordMode);
+        fill(anim, anim + n*n, 0.0f);
+        animator.clear();
+        marksDirty = true;
     }
 
+    // 0 empty, 1 = X, 2 = O
+    int cellAt(int i, int j) const { return match.pos.cellAt(i*n + j); }
+
     int getN() const { return n; }
-    int getCurrentPlayer() const { return currentPlayer; }
-    bool isGameOver() const { return gameOver; }
-    int getWinner() const { return winner; }
+    int getCurrentPlayer() const { return match.toMove; }
+    bool isGameOver() const { return match.over; }
+    int getWinner() const { return match.winner; }
     int getScoreX() const { return scoreX; }
     int getScoreO() const { return scoreO; }
+    long long getNodes() const { return lastSearch.nodes; }
+    const SearchResult& getLastSearch() const { return lastSearch; }
 
     // ---------- drawing helpers ----------
-    void drawText(float x, float y, const char* text, float r=0, float g=0, float b=0) {
-        glColor3f(r,g,b);
-        glRasterPos2f(x,y);
-        for (const char* c = text; *c; ++c) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+    void drawGrid(float startX, float startY, float cellSize) {
+        if (startX != gridX || startY != gridY || cellSize != gridCell) {
+            buildGrid(startX, startY, cellSize);
+            gridX = startX; gridY = startY; gridCell = cellSize;
+            marksDirty = true;
+        }
+        cellQuads.draw();
+        gridLines.draw(3);
+        border.draw(5);
     }
 
-    void drawGrid(float startX, float startY, float cellSize) {
+    void buildGrid(float startX, float startY, float cellSize) {
         // white cells
+        cellQuads.clear();
+        cellQuads.color(1,1,1);
         for(int i=0;i<n;i++){
             for(int j=0;j<n;j++){
-                glColor3f(1,1,1);
-                glBegin(GL_QUADS);
-                    glVertex2f(startX + j*cellSize, startY + i*cellSize);
-                    glVertex2f(startX + (j+1)*cellSize, startY + i*cellSize);
-                    glVertex2f(startX + (j+1)*cellSize, startY + (i+1)*cellSize);
-                    glVertex2f(startX + j*cellSize, startY + (i+1)*cellSize);
-                glEnd();
+                cellQuads.vertex(startX + j*cellSize, startY + i*cellSize);
+                cellQuads.vertex(startX + (j+1)*cellSize, startY + i*cellSize);
+                cellQuads.vertex(startX + (j+1)*cellSize, startY + (i+1)*cellSize);
+                cellQuads.vertex(startX + j*cellSize, startY + (i+1)*cellSize);
             }
         }
         // grid lines
-        glColor3f(0.6f,0.6f,0.6f);
-        glLineWidth(3);
+        gridLines.clear();
+        gridLines.color(0.6f,0.6f,0.6f);
         float total = cellSize * n;
         for(int i=1;i<n;i++){
-            glBegin(GL_LINES);
-                glVertex2f(startX + i*cellSize, startY);
-                glVertex2f(startX + i*cellSize, startY + total);
-            glEnd();
-            glBegin(GL_LINES);
-                glVertex2f(startX, startY + i*cellSize);
-                glVertex2f(startX + total, startY + i*cellSize);
-            glEnd();
+            gridLines.vertex(startX + i*cellSize, startY);
+            gridLines.vertex(startX + i*cellSize, startY + total);
+            gridLines.vertex(startX, startY + i*cellSize);
+            gridLines.vertex(startX + total, startY + i*cellSize);
         }
         // border
-        glColor3f(0.9f,0.65f,0.18f);
-        glLineWidth(5);
-        glBegin(GL_LINE_LOOP);
-            glVertex2f(startX, startY);
-            glVertex2f(startX + total, startY);
-            glVertex2f(startX + total, startY + total);
-            glVertex2f(startX, startY + total);
-        glEnd();
-        glLineWidth(1);
+        border.clear();
+        border.color(0.9f,0.65f,0.18f);
+        const float corner[5][2] = {{0,0}, {total,0}, {total,total}, {0,total}, {0,0}};
+        for(int k=0;k<4;k++){
+            border.vertex(startX + corner[k][0], startY + corner[k][1]);
+            border.vertex(startX + corner[k+1][0], startY + corner[k+1][1]);
+        }
     }
 
+    // X and O share one batch: both are 6 px lines, coloured per vertex
     void drawMarks(float startX, float startY, float cellSize) {
-        for(int i=0;i<n;i++){
-            for(int j=0;j<n;j++){
-                float x = startX + j*cellSize;
-                float y = startY + i*cellSize;
-                float scale = anim[i][j];
-                if (board[i][j] == 1) {
-                    // X - purple
-                    float margin = 12 + (cellSize/2 - 12)*(1 - scale);
-                    glColor3f(0.45f,0.12f,0.7f);
-                    glLineWidth(6);
-                    glBegin(GL_LINES);
-                        glVertex2f(x+margin, y+margin);
-                        glVertex2f(x+cellSize-margin, y+cellSize-margin);
-                        glVertex2f(x+cellSize-margin, y+margin);
-                        glVertex2f(x+margin, y+cellSize-margin);
-                    glEnd();
-                    glLineWidth(1);
-                } else if (board[i][j] == 2) {
-                    // O - peach
-                    float cx = x + cellSize/2;
-                    float cy = y + cellSize/2;
-                    float radius = (cellSize/2.8f) * scale;
-                    glColor3f(1.0f,0.42f,0.4f);
-                    glLineWidth(6);
-                    glBegin(GL_LINE_LOOP);
-                        for(int k=0;k<=100;k++){
-                            float a = 2*3.1415926f*k/100.0f;
-                            glVertex2f(cx + cos(a)*radius, cy + sin(a)*radius);
-                        }
-                    glEnd();
-                    glLineWidth(1);
+        if (marksDirty) {
+            buildMarks(startX, startY, cellSize);
+            marksDirty = false;
+        }
+        markLines.draw(6);
+    }
+
+    void buildMarks(float startX, float startY, float cellSize) {
+        markLines.clear();
+        for (Mask m = match.pos.bb[1] | match.pos.bb[2]; m; m.clearLowest()) {
+            int c = lowestBit(m), i = c / n, j = c % n;
+            float x = startX + j*cellSize;
+            float y = startY + i*cellSize;
+            float scale = anim[c];
+            if (match.pos.cellAt(c) == 1) {
+                // X - purple
+                float margin = 12 + (cellSize/2 - 12)*(1 - scale);
+                markLines.color(0.45f,0.12f,0.7f);
+                markLines.vertex(x+margin, y+margin);
+                markLines.vertex(x+cellSize-margin, y+cellSize-margin);
+                markLines.vertex(x+cellSize-margin, y+margin);
+                markLines.vertex(x+margin, y+cellSize-margin);
+            } else {
+                // O - peach
+                float cx = x + cellSize/2;
+                float cy = y + cellSize/2;
+                float radius = (cellSize/2.8f) * scale;
+                markLines.color(1.0f,0.42f,0.4f);
+                for(int k=0;k<100;k++){
+                    markLines.vertex(cx + unitCircle.x[k]*radius, cy + unitCircle.y[k]*radius);
+                    markLines.vertex(cx + unitCircle.x[k+1]*radius, cy + unitCircle.y[k+1]*radius);
                 }
             }
         }
     }
 
+    // Bring growing marks up to date before they are drawn
     void updateAnimation() {
-        bool changed=false;
-        for(int i=0;i<n;i++) for(int j=0;j<n;j++){
-            if(board[i][j] != 0 && anim[i][j] < 1.0f){
-                anim[i][j] += 0.03f;
-                if(anim[i][j] > 1.0f) anim[i][j] = 1.0f;
-                changed = true;
-            }
-        }
-        if(changed) glutPostRedisplay();
+        if(!animator.running()) return;
+        animator.update([this](int cell, float scale){ anim[cell] = scale; });
+        marksDirty = true;
+        if(animator.running()) requestAnimationFrame();
     }
 
     // ---------- game logic ----------
     bool checkWinFor(int p) {
-        // rows & cols
-        for(int i=0;i<n;i++){
-            bool r=true, c=true;
-            for(int j=0;j<n;j++){
-                if(board[i][j] != p) r=false;
-                if(board[j][i] != p) c=false;
-            }
-            if(r || c) return true;
-        }
-        // diagonals
-        bool d1=true, d2=true;
-        for(int i=0;i<n;i++){
-            if(board[i][i] != p) d1=false;
-            if(board[i][n-1-i] != p) d2=false;
-        }
-        return d1 || d2;
+        return match.pos.hasWon(p);
     }
 
     bool isDraw() {
-        for(int i=0;i<n;i++)
-            for(int j=0;j<n;j++)
-                if(board[i][j] == 0) return false;
-        return true;
+        return match.pos.isFull();
     }
 
     // Place a move for human (or player2). x,y are window coords; returns true if placed
@@ -212,144 +547,116 @@ public:
         int col = int((wx - startX) / cellSize);
         int row = int((wy - startY) / cellSize);
         if (row < 0 || row >= n || col < 0 || col >= n) return false;
-        if (board[row][col] != 0) return false;
-        board[row][col] = currentPlayer;
-        anim[row][col] = 0.0f;
-        // check end
-        if (checkWinFor(currentPlayer)) {
-            gameOver = true;
-            winner = currentPlayer;
-            if (winner == 1) scoreX++; else scoreO++;
-        } else if (isDraw()) {
-            gameOver = true;
-            winner = 0; // draw
-        } else {
-            currentPlayer = 3 - currentPlayer;
-        }
+        if (!match.play(row*n + col)) return false;
+        anim[row*n + col] = 0.0f;
+        animator.start(row*n + col);
+        marksDirty = true;
+        countResult();
+        recordMove(row*n + col);
         return true;
     }
 
-    // ---------- Minimax with alpha-beta ----------
-    // Evaluate: +100 - depth if O wins, -100 + depth if X wins, 0 draw
-    int evaluate(int depth) {
-        if (checkWinFor(2)) return 100 - depth;
-        if (checkWinFor(1)) return -100 + depth;
-        return 0;
+    // Credit the winner once the game has just ended
+    void countResult() {
+        if (match.winner == 1) scoreX++;
+        else if (match.winner == 2) scoreO++;
     }
 
-    int minimaxAB(bool isMaximizing, int depth, int alpha, int beta) {
-        if (checkWinFor(2) || checkWinFor(1) || isDraw()) {
-            return evaluate(depth);
-        }
-        if (isMaximizing) {
-            int best = numeric_limits<int>::min();
-            for(int i=0;i<n;i++){
-                for(int j=0;j<n;j++){
-                    if(board[i][j] == 0){
-                        board[i][j] = 2;
-                        int val = minimaxAB(false, depth+1, alpha, beta);
-                        board[i][j] = 0;
-                        best = max(best, val);
-                        alpha = max(alpha, best);
-                        if(beta <= alpha) return best;
-                    }
-                }
-            }
-            return best;
-        } else {
-            int best = numeric_limits<int>::max();
-            for(int i=0;i<n;i++){
-                for(int j=0;j<n;j++){
-                    if(board[i][j] == 0){
-                        board[i][j] = 1;
-                        int val = minimaxAB(true, depth+1, alpha, beta);
-                        board[i][j] = 0;
-                        best = min(best, val);
-                        beta = min(beta, best);
-                        if(beta <= alpha) return best;
-                    }
-                }
-            }
-            return best;
-        }
+    void recordMove(int cell) {
+        record.add(cell);
+        if (match.over) saveRecord();
+    }
+
+    // Who is playing, for the games recorded from the next start on
+    void setRecordMode(RecordMode mode) { recordMode = mode; }
+
+    // Append the game to the archive once: when it ends, or unfinished when
+    // the board is cleared or left
+    void saveRecord() {
+        if (record.moveCount == 0) return;
+        record.result = gameResult(match);
+        gameArchive.write(record);   // on disk a block at a time; closeArchive writes the rest
+        record.moveCount = 0;
     }
 
-    // Choose best move for computer (player 2)
+    // ---------- Minimax with alpha-beta ----------
+    // The search itself lives in Searcher; with more than one thread the root is
+    // split across the search pool and returns the same move as the serial search.
     pair<int,int> findBestMove() {
-        int bestVal = numeric_limits<int>::min();
-        pair<int,int> move = {-1,-1};
-        for(int i=0;i<n;i++){
-            for(int j=0;j<n;j++){
-                if(board[i][j] == 0){
-                    board[i][j] = 2;
-                    int moveVal = minimaxAB(false, 0, numeric_limits<int>::min(), numeric_limits<int>::max());
-                    board[i][j] = 0;
-                    if(moveVal > bestVal){
-                        bestVal = moveVal;
-                        move = {i,j};
-                    }
-                }
-            }
-        }
-        return move;
+        lastSearch = searchBestMove(match.pos);
+        if (lastSearch.cell < 0) return {-1,-1};
+        return {lastSearch.cell / n, lastSearch.cell % n};
     }
 
+    // Snapshot for searching off the GUI thread
+    const Position& getPosition() const { return match.pos; }
+
     // Called to let computer play (with animation setup and updating state)
     void computerPlay() {
-        if(gameOver) return;
+        if(match.over) return;
         pair<int,int> m = findBestMove();
-        if(m.first != -1){
-            board[m.first][m.second] = 2;
-            anim[m.first][m.second] = 0.0f;
-            if (checkWinFor(2)) {
-                gameOver = true;
-                winner = 2;
-                scoreO++;
-            } else if (isDraw()) {
-                gameOver = true;
-                winner = 0;
-            } else {
-                currentPlayer = 1;
-            }
-        }
+        if(m.first != -1) applyComputerMove(m.first, m.second);
+    }
+
+    // Play the computer's chosen cell, e.g. a result handed back by a background search
+    void applyComputerMove(int row, int col, const SearchResult* stats = nullptr, const SearchStats* counters = nullptr) {
+        if (stats) lastSearch = *stats;
+        if (counters) lastCounters = *counters;
+        if (match.toMove != 2 || !match.play(row*n + col)) return;
+        anim[row*n + col] = 0.0f;
+        animator.start(row*n + col);
+        marksDirty = true;
+        countResult();
+        recordMove(row*n + col);
     }
 
     // Draw everything given current viewport; handles name/roll/score text
     void renderFull(float startX, float startY, float cellSize) {
+        updateAnimation();
         drawGrid(startX, startY, cellSize);
         drawMarks(startX, startY, cellSize);
         // texts: name/roll/score
-        drawText(20, WIN_H - 30, "Name: Mst. Shajia Tabassum Orthe", 0,0,0);
-        drawText(20, WIN_H - 55, "Roll: 230101", 0,0,0);
+        nameText.draw(20, WIN_H - 30, "Name: Mst. Shajia Tabassum Orthe", 0,0,0);
+        rollText.draw(20, WIN_H - 55, "Roll: 230101", 0,0,0);
         char buf[64];
         sprintf(buf, "Score -> X: %d   O: %d", scoreX, scoreO);
-        drawText(20, WIN_H - 80, buf, 0,0,0);
+        scoreText.draw(20, WIN_H - 80, buf, 0,0,0);
+        if (showSearchStats && lastSearch.cell >= 0) drawSearchStats();
 
         // result
-        if(gameOver){
-            if(winner == 1) drawText(WIN_W/2 - 90, WIN_H/2 + 10, "Player X Wins!", 1,0.8f,0.1f);
-            else if(winner == 2) drawText(WIN_W/2 - 90, WIN_H/2 + 10, "Player O Wins!", 1,0.8f,0.1f);
-            else drawText(WIN_W/2 - 60, WIN_H/2 + 10, "Match Draw!", 1,0.6f,0.2f);
-            drawText(WIN_W/2 - 130, WIN_H/2 - 20, "Click Restart button or Back to Menu", 0.2f,0.2f,0.2f);
+        if(match.over){
+            if(match.winner == 1) resultText.draw(WIN_W/2 - 90, WIN_H/2 + 10, "Player X Wins!", 1,0.8f,0.1f);
+            else if(match.winner == 2) resultText.draw(WIN_W/2 - 90, WIN_H/2 + 10, "Player O Wins!", 1,0.8f,0.1f);
+            else resultText.draw(WIN_W/2 - 60, WIN_H/2 + 10, "Match Draw!", 1,0.6f,0.2f);
+            hintText.draw(WIN_W/2 - 130, WIN_H/2 - 20, "Click Restart button or Back to Menu", 0.2f,0.2f,0.2f);
         }
+    }
 
-        updateAnimation();
+    // Counters of the computer's last move, under the thinking indicator
+    void drawSearchStats() {
+        const SearchResult &r = lastSearch;
+        const SearchStats &s = lastCounters;
+        const long long probes = r.ttHits + r.ttMisses;
+        const long long cuts = s.totalCutoffs();
+        char buf[128];
+        sprintf(buf, "Depth %d  %lld nodes  %.2fs  %.0fk nodes/s",
+                r.depth, r.nodes, r.seconds, r.seconds > 0 ? r.nodes / r.seconds / 1000 : 0.0);
+        statsText.draw(WIN_W - 340, WIN_H - 55, buf, 0.1f,0.3f,0.6f);
+        sprintf(buf, "TT hits %.0f%%  branching %.2f  cutoffs %lld (%.0f%% 1st)",
+                probes ? 100.0 * r.ttHits / probes : 0.0, s.branching(), cuts,
+                cuts ? 100.0 * s.firstMoveCutoffs / cuts : 0.0);
+        cutoffText.draw(WIN_W - 340, WIN_H - 80, buf, 0.1f,0.3f,0.6f);
     }
 
     // Manual restart (keep scores)
     void manualRestart() {
-        for (int i=0;i<n;i++) for(int j=0;j<n;j++){
-            board[i][j] = 0;
-            anim[i][j] = 0.0f;
-        }
-        currentPlayer = 1;
-        gameOver = false;
-        winner = 0;
+        resetBoard();
     }
 };
 
 // ---------- Global game pointer ----------
-TicTacToe* game = nullptr;
+TicTacToe gameSlot;           // the one game object, restarted for every match
+TicTacToe* game = nullptr;    // &gameSlot while playing, nullptr in the menus
 
 // ---------- Utility: Buttons ----------
 struct Button {
@@ -377,27 +684,108 @@ void computeBoardViewport(float &startX, float &startY, float &cellSize) {
 
 // ---------- Drawing background ----------
 void drawBackground() {
-    glBegin(GL_QUADS);
-        glColor3f(0.85f,0.93f,0.98f); glVertex2f(0,0);
-        glColor3f(0.75f,0.88f,0.95f); glVertex2f(WIN_W,0);
-        glColor3f(0.65f,0.84f,0.92f); glVertex2f(WIN_W,WIN_H);
-        glColor3f(0.75f,0.88f,0.96f); glVertex2f(0,WIN_H);
-    glEnd();
+    static VertexBatch quad(GL_QUADS);
+    static int builtW = -1, builtH = -1;
+    if(builtW != WIN_W || builtH != WIN_H){
+        quad.clear();
+        quad.color(0.85f,0.93f,0.98f); quad.vertex(0,0);
+        quad.color(0.75f,0.88f,0.95f); quad.vertex(WIN_W,0);
+        quad.color(0.65f,0.84f,0.92f); quad.vertex(WIN_W,WIN_H);
+        quad.color(0.75f,0.88f,0.96f); quad.vertex(0,WIN_H);
+        builtW = WIN_W; builtH = WIN_H;
+    }
+    quad.draw();
+}
+
+// Buttons shown together: their quads are one batch, rebuilt when setupButtons
+// lays the buttons out again
+int buttonLayout = 0;   // bumped by setupButtons
+struct ButtonGroup {
+    VertexBatch quads{GL_QUADS};
+    VertexBatch labels{GL_QUADS, true};   // all labels in one batch once the atlas exists
+    int builtFor = -1;
+};
+
+void drawButtons(ButtonGroup &group, const vector<const Button*> &buttons) {
+    if(group.builtFor != buttonLayout || (glyphAtlas.ready() && group.labels.empty())){
+        group.quads.clear();
+        group.quads.color(0.18f,0.45f,0.8f);
+        for(const Button* b : buttons){
+            group.quads.vertex(b->x, b->y);
+            group.quads.vertex(b->x + b->w, b->y);
+            group.quads.vertex(b->x + b->w, b->y + b->h);
+            group.quads.vertex(b->x, b->y + b->h);
+        }
+        group.labels.clear();
+        group.labels.color(1,1,1);
+        if(glyphAtlas.ready())
+            for(const Button* b : buttons) glyphAtlas.layout(group.labels, b->x + 10, b->y + b->h/2 - 7, b->label.c_str());
+        group.builtFor = buttonLayout;
+    }
+    group.quads.draw();
+    if(glyphAtlas.ready()){
+        glyphAtlas.draw(group.labels);
+    } else {
+        glColor3f(1,1,1);
+        for(const Button* b : buttons) drawBitmapText(b->x + 10, b->y + b->h/2 - 7, b->label.c_str());
+    }
+}
+
+// ---------- Background computer move ----------
+// The search runs on its own thread against a copy of the board; a GLUT timer
+// polls for the result so the window keeps redrawing and taking clicks.
+struct AiJob {
+    thread worker;
+    SearchControl control;
+    atomic<bool> done{false};
+    SearchResult result;
+    SearchStats stats;    // filled when wantSearchStats()
+    chrono::steady_clock::time_point started;
+    bool active = false;
+    int generation = 0;   // bumped on cancel so stale timers do nothing
+};
+AiJob aiJob;
+const int AI_POLL_MS = 30;
+int moveTimeMs = 1000;   // --move-ms: computer's budget per move
+enum EngineKind { ENGINE_MINIMAX, ENGINE_MCTS };
+EngineKind defaultEngine = ENGINE_MINIMAX;    // --engine
+EngineKind computerEngine = ENGINE_MINIMAX;   // the current game's, picked in the menu
+long long mctsPlayouts = 0;                   // --playouts: 0 = use moveTimeMs
+
+// Stop a running search and wait for its thread; the result is discarded.
+void cancelComputerMove() {
+    ++aiJob.generation;
+    if(!aiJob.active) return;
+    aiJob.control.stop = true;
+    aiJob.worker.join();
+    aiJob.active = false;
 }
 
-// helper draw simple button
-void drawButton(const Button &b, bool highlight=false) {
-    if(highlight) glColor3f(0.25f,0.6f,0.95f);
-    else glColor3f(0.18f,0.45f,0.8f);
-    glBegin(GL_QUADS);
-        glVertex2f(b.x, b.y);
-        glVertex2f(b.x + b.w, b.y);
-        glVertex2f(b.x + b.w, b.y + b.h);
-        glVertex2f(b.x, b.y + b.h);
-    glEnd();
-    glColor3f(1,1,1);
-    glRasterPos2f(b.x + 10, b.y + b.h/2 - 7);
-    for (const char* c = b.label.c_str(); *c; ++c) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+// GLUT destroys the window (and its GL context) after this; the static
+// batches are destroyed later, at exit, and must not call GL then.
+void onWindowClose() {
+    cancelComputerMove();
+    glBuffers.contextLive = false;
+    if(game) game->saveRecord();
+    closeArchive();
+}
+
+void pollComputer(int generation) {
+    if(generation != aiJob.generation || !aiJob.active) return;
+    if(!aiJob.done){
+        glutPostRedisplay();   // refresh the thinking indicator
+        glutTimerFunc(AI_POLL_MS, pollComputer, generation);
+        return;
+    }
+    aiJob.worker.join();
+    aiJob.active = false;
+    if(game && aiJob.result.cell >= 0){
+        int n = game->getN();
+        if(searchLog.isOpen()) searchLog.write(game->getPosition(), aiJob.result, aiJob.stats);
+        game->applyComputerMove(aiJob.result.cell / n, aiJob.result.cell % n, &aiJob.result,
+                                aiJob.control.stats);
+    }
+    glutPostRedisplay();
 }
 
 // ---------- Display callbacks ----------
@@ -407,29 +795,29 @@ void displayMenu() {
     drawBackground();
 
     // title
-    glColor3f(0.08f,0.2f,0.4f);
-    glRasterPos2f(WIN_W/2 - 120, WIN_H - 80);
-    const char* title = "Tic Tac Toe - Choose Mode and Size";
-    for (const char* c = title; *c; ++c) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+    static TextLabel title;
+    title.draw(WIN_W/2 - 120, WIN_H - 80, "Tic Tac Toe - Choose Mode and Size", 0.08f,0.2f,0.4f);
 
     if(menuStep == MODE_SELECT) {
-        // draw buttons for modes
-        for (auto &b: menuButtonsMode) drawButton(b);
+        // draw buttons for modes, and quit bottom-right
+        static ButtonGroup modeGroup;
+        vector<const Button*> buttons;
+        for (auto &b: menuButtonsMode) buttons.push_back(&b);
+        buttons.push_back(&btnQuit);
+        drawButtons(modeGroup, buttons);
         // small hint
-        glColor3f(0,0,0);
-        const char* hint = "Choose Mode -> then click Next (Select size)";
-        glRasterPos2f(WIN_W/2 - 140, WIN_H/2 - 80);
-        for(const char* c=hint; *c; ++c) glutBitmapCharacter(GLUT_BITMAP_HELVETICA_18, *c);
+        static TextLabel hint;
+        hint.draw(WIN_W/2 - 140, WIN_H/2 - 80, "Choose Mode -> then click Next (Select size)", 0,0,0);
     } else {
-        // size select
-        for (auto &b: menuButtonsSize) drawButton(b);
-        // back button
-        drawButton(btnBackToMenu);
+        // size select, back and quit
+        static ButtonGroup sizeGroup;
+        vector<const Button*> buttons;
+        for (auto &b: menuButtonsSize) buttons.push_back(&b);
+        buttons.push_back(&btnBackToMenu);
+        buttons.push_back(&btnQuit);
+        drawButtons(sizeGroup, buttons);
     }
 
-    // quit button bottom-right
-    drawButton(btnQuit);
-
     glutSwapBuffers();
 }
 
@@ -442,11 +830,19 @@ void displayGame() {
 
     if(game) {
         game->renderFull(sx, sy, cs);
+        if(aiJob.active){
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - aiJob.started).count();
+            char buf[96];
+            sprintf(buf, "Computer thinking... %.1fs  %lld %s", sec, aiJob.control.nodes.load(),
+                    computerEngine == ENGINE_MCTS ? "playouts" : "nodes");
+            static TextLabel thinking;
+            thinking.draw(WIN_W - 340, WIN_H - 30, buf, 0.1f,0.3f,0.6f);
+        }
     }
 
     // draw Restart and Back buttons
-    drawButton(btnRestart);
-    drawButton(btnBackToMenu);
+    static ButtonGroup gameGroup;
+    drawButtons(gameGroup, {&btnRestart, &btnBackToMenu});
 
     glutSwapBuffers();
 }
@@ -458,9 +854,23 @@ bool pointInButton(int mx, int my, const Button &b) {
 
 // ---------- Timer for computer move ----------
 void timerComputer(int value) {
+    if(value != aiJob.generation || aiJob.active) return;
     if(game && !game->isGameOver() && selectedMode == HUMAN_VS_COMPUTER && game->getCurrentPlayer() == 2){
-        game->computerPlay();
-        glutPostRedisplay();
+        const bool mcts = computerEngine == ENGINE_MCTS;
+        aiJob.control.timeLimit = mcts && mctsPlayouts > 0 ? 0 : moveTimeMs / 1000.0;
+        aiJob.control.nodeLimit = mcts ? mctsPlayouts : 0;
+        aiJob.control.stats = wantSearchStats() ? &aiJob.stats : nullptr;
+        aiJob.control.start();
+        aiJob.done = false;
+        aiJob.started = chrono::steady_clock::now();
+        aiJob.active = true;
+        Position snapshot = game->getPosition();
+        aiJob.worker = thread([snapshot, mcts](){
+            aiJob.result = mcts ? searchBestMoveMcts(snapshot, &aiJob.control)
+                                : searchBestMove(snapshot, &aiJob.control);
+            aiJob.done = true;
+        });
+        glutTimerFunc(AI_POLL_MS, pollComputer, aiJob.generation);
     }
 }
 
@@ -475,7 +885,8 @@ void mouseFunc(int button, int state, int mx, int my) {
             // buttons for mode
             for(size_t i=0;i<menuButtonsMode.size();++i){
                 if(pointInButton(mx, y, menuButtonsMode[i])){
-                    if(i==0) selectedMode = HUMAN_VS_COMPUTER;
+                    if(i==0) selectedMode = HUMAN_VS_COMPUTER, computerEngine = defaultEngine;
+                    else if(i==1) selectedMode = HUMAN_VS_COMPUTER, computerEngine = ENGINE_MCTS;
                     else selectedMode = HUMAN_VS_HUMAN;
                     // go to size selection
                     menuStep = SIZE_SELECT;
@@ -485,16 +896,19 @@ void mouseFunc(int button, int state, int mx, int my) {
             }
             if(pointInButton(mx,y,btnQuit)){
                 // exit
+                closeArchive();
                 exit(0);
             }
         } else { // SIZE_SELECT
             for(size_t i=0;i<menuButtonsSize.size();++i){
                 if(pointInButton(mx,y,menuButtonsSize[i])){
-                    selectedSize = (i==0?3:4);
+                    selectedSize = i + 3 <= GUI_MAX_N ? 3 + (int)i : GOMOKU_N;
                     // start game
                     appState = STATE_PLAY;
-                    if(game) delete game;
-                    game = new TicTacToe(selectedSize);
+                    game = &gameSlot;
+                    game->setRecordMode(selectedMode == HUMAN_VS_HUMAN ? RECORD_HUMAN_VS_HUMAN
+                                        : computerEngine == ENGINE_MCTS ? RECORD_VS_MCTS : RECORD_VS_MINIMAX);
+                    game->start(selectedSize, selectedSize == GOMOKU_N ? GOMOKU_K : selectedSize);
                     // initial redraw
                     glutPostRedisplay();
                     return;
@@ -508,14 +922,17 @@ void mouseFunc(int button, int state, int mx, int my) {
                 return;
             }
             if(pointInButton(mx,y,btnQuit)){
+                closeArchive();
                 exit(0);
             }
         }
     } else if(appState == STATE_PLAY) {
         // Back to menu
         if(pointInButton(mx,y,btnBackToMenu)){
-            // free game and return to menu
-            if(game) { delete game; game = nullptr; }
+            // leave the game and return to menu
+            cancelComputerMove();
+            if(game) game->saveRecord();
+            game = nullptr;
             appState = STATE_MENU;
             menuStep = MODE_SELECT;
             selectedMode = MODE_NONE;
@@ -525,6 +942,7 @@ void mouseFunc(int button, int state, int mx, int my) {
         }
         // Restart button
         if(pointInButton(mx,y,btnRestart)){
+            cancelComputerMove();
             if(game){
                 game->manualRestart();
                 glutPostRedisplay();
@@ -552,7 +970,7 @@ void mouseFunc(int button, int state, int mx, int my) {
                     glutPostRedisplay();
                     // if now computer's turn, schedule timer
                     if(selectedMode == HUMAN_VS_COMPUTER && game->getCurrentPlayer() == 2 && !game->isGameOver()){
-                        glutTimerFunc(300, timerComputer, 0); // 300ms delay
+                        glutTimerFunc(300, timerComputer, aiJob.generation); // 300ms delay
                     }
                 }
             }
@@ -561,36 +979,56 @@ void mouseFunc(int button, int state, int mx, int my) {
 }
 
 // ---------- Reshape ----------
+void setupButtons();
+
 void reshape(int w, int h){
     WIN_W = w; WIN_H = h;
     glViewport(0,0,w,h);
     glMatrixMode(GL_PROJECTION); glLoadIdentity();
     gluOrtho2D(0, w, 0, h);
     glMatrixMode(GL_MODELVIEW); glLoadIdentity();
+    setupButtons();   // buttons are laid out relative to the window
+    glutPostRedisplay();
 }
 
-// ---------- Idle / display router ----------
+// ---------- Display router ----------
 void displayRouter(){
+    frameStart = chrono::steady_clock::now();
+    if(!glyphAtlas.ready()) glyphAtlas.build(WIN_W, WIN_H);
     if(appState == STATE_MENU) displayMenu();
     else displayGame();
+    frameStats.frames++;
+    frameStats.drawSec += chrono::duration<double>(chrono::steady_clock::now() - frameStart).count();
 }
 
 // ---------- Setup buttons layout ----------
 void setupButtons(){
+    ++buttonLayout;
     menuButtonsMode.clear();
     menuButtonsSize.clear();
 
     // Mode buttons (centered)
-    Button b1; b1.w = 260; b1.h = 60; b1.x = (WIN_W - b1.w)/2.0f; b1.y = WIN_H/2 + 40; b1.label = "Player1  VS  Computer";
+    Button b1; b1.w = 260; b1.h = 60; b1.x = (WIN_W - b1.w)/2.0f; b1.y = WIN_H/2 + 120; b1.label = "Player1  VS  Computer";
+    Button bMcts = b1; bMcts.y = WIN_H/2 + 40; bMcts.label = "Player1  VS  Computer (MCTS)";
     Button b2 = b1; b2.y = WIN_H/2 - 40; b2.label = "Player1  VS  Player2";
     menuButtonsMode.push_back(b1);
+    menuButtonsMode.push_back(bMcts);
     menuButtonsMode.push_back(b2);
 
-    // Size buttons
-    Button s1; s1.w = 200; s1.h = 60; s1.x = (WIN_W - s1.w)/2.0f; s1.y = WIN_H/2 + 10; s1.label = "3 x 3";
-    Button s2 = s1; s2.y = WIN_H/2 - 90; s2.label = "4 x 4";
-    menuButtonsSize.push_back(s1);
-    menuButtonsSize.push_back(s2);
+    // Size buttons: 3x3 .. GUI_MAX_N x GUI_MAX_N in two columns, Gomoku below
+    for(int size=3; size<=GUI_MAX_N; size++){
+        int k = size - 3;
+        Button s; s.w = 150; s.h = 50;
+        s.x = WIN_W/2.0f + (k%2 == 0 ? -s.w - 10 : 10);
+        s.y = WIN_H/2 + 110 - (k/2)*70;
+        s.label = to_string(size) + " x " + to_string(size);
+        menuButtonsSize.push_back(s);
+    }
+    Button gomoku; gomoku.w = 310; gomoku.h = 50;
+    gomoku.x = (WIN_W - gomoku.w)/2.0f;
+    gomoku.y = WIN_H/2 + 110 - ((GUI_MAX_N - 2)/2)*70;
+    gomoku.label = to_string(GOMOKU_N) + " x " + to_string(GOMOKU_N) + "  (" + to_string(GOMOKU_K) + " in a row)";
+    menuButtonsSize.push_back(gomoku);
 
     // Back, Restart, Quit
     btnBackToMenu.w = 160; btnBackToMenu.h = 45; btnBackToMenu.x = 20; btnBackToMenu.y = 20; btnBackToMenu.label = "Back to Menu";
@@ -600,6 +1038,42 @@ void setupButtons(){
 
 // ---------- Main ----------
 int main(int argc, char** argv){
+    const char* bookPath = "tictactoe.book";
+    const char* recordPath = "tictactoe.games";
+    const char* cachePath = "tictactoe.cache";
+    size_t cacheMb = 4;
+    for(int i=1;i<argc;i++){
+        if(strcmp(argv[i], "--tt-mb") == 0 && i+1 < argc) transTable.resize(atoi(argv[++i]));
+        else if(strcmp(argv[i], "--threads") == 0 && i+1 < argc) searchThreads = max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--move-ms") == 0 && i+1 < argc) moveTimeMs = max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--engine") == 0 && i+1 < argc)
+            defaultEngine = strcmp(argv[++i], "mcts") == 0 ? ENGINE_MCTS : ENGINE_MINIMAX;
+        else if(strcmp(argv[i], "--playouts") == 0 && i+1 < argc) mctsPlayouts = max(0LL, atoll(argv[++i]));
+        else if(strcmp(argv[i], "--proof-nodes") == 0 && i+1 < argc) proofProbeNodes = max(0LL, atoll(argv[++i]));
+        else if(strcmp(argv[i], "--book") == 0 && i+1 < argc) bookPath = argv[++i];
+        else if(strcmp(argv[i], "--record") == 0 && i+1 < argc) recordPath = argv[++i];
+        else if(strcmp(argv[i], "--no-record") == 0) recordPath = nullptr;
+        else if(strcmp(argv[i], "--cache") == 0 && i+1 < argc) cachePath = argv[++i];
+        else if(strcmp(argv[i], "--cache-mb") == 0 && i+1 < argc) cacheMb = max(1, atoi(argv[++i]));
+        else if(strcmp(argv[i], "--no-cache") == 0) cachePath = nullptr;
+        else if(strcmp(argv[i], "--frame-stats") == 0) showFrameStats = true;
+        else if(strcmp(argv[i], "--search-stats") == 0) showSearchStats = true;
+        else if(strcmp(argv[i], "--search-log") == 0 && i+1 < argc){
+            const char* path = argv[++i];
+            if(!searchLog.open(path)) printf("Cannot write search log %s\n", path);
+        }
+        else if(strcmp(argv[i], "--gen-book") == 0){
+            const char* path = i+1 < argc ? argv[i+1] : "tictactoe.book";
+            if(!generateBook(path)){
+                fprintf(stderr, "could not write %s\n", path);
+                return 1;
+            }
+            return 0;
+        }
+    }
+    openingBook.load(bookPath);   // optional: without it the small boards are searched
+    if(recordPath && !gameArchive.open(recordPath)) printf("Cannot append to game archive %s\n", recordPath);
+    if(cachePath && !searchCache.open(cachePath, cacheMb)) printf("Cannot use search cache %s\n", cachePath);
     srand((unsigned int)time(nullptr));
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_DOUBLE | GLUT_RGB);
@@ -607,30 +1081,23 @@ int main(int argc, char** argv){
     glutCreateWindow("Tic Tac Toe - Strong Computer (Minimax) - Orthe");
 
     glClearColor(1,1,1,1);
+    loadBufferFunctions();
+    enableVsync();
 
     setupButtons();
 
     glutDisplayFunc(displayRouter);
     glutReshapeFunc(reshape);
     glutMouseFunc(mouseFunc);
+    glutCloseFunc(onWindowClose);
 
-    // Note: when window size changes, update button layout
-    // We'll re-setup on reshape by installing a small lambda via idle - simpler: wrap reshape to call setupButtons
-    // But glutReshapeFunc can't be a lambda capturing setupButtons - we'll call setupButtons at start and also rely on user not resizing heavily.
-    // For robustness, set an idle to recompute button positions when size changes:
-    glutIdleFunc([](){
-        static int lastW = WIN_W, lastH = WIN_H;
-        if(lastW != WIN_W || lastH != WIN_H){
-            setupButtons();
-            lastW = WIN_W; lastH = WIN_H;
-        }
-        glutPostRedisplay();
-    });
+    if(showFrameStats) glutTimerFunc(1000, reportFrameStats, 0);
 
     glutMainLoop();
 
     // cleanup
-    if(game) { delete game; game = nullptr; }
+    cancelComputerMove();
+    game = nullptr;
 
     return 0;
 }
@@ -0,0 +1,261 @@
+// File: tools/loadgen.cpp
+// Load generator for tictactoe-server: many games at once over a few
+// connections, each client playing random legal moves as X. Linux/POSIX.
+// g++ -O2 -I. tools/loadgen.cpp -o tictactoe-loadgen -pthread
+//
+//   tictactoe-loadgen --port 7878 --connections 8 --games 256 --seconds 10
+//   --unix /tmp/tictactoe.sock   connect there instead of TCP (--host, --port)
+//   --games 256                  games in flight per connection
+//   --size 3 --k 3               board, k in a row (default: the whole side)
+//   --move-ms 0                  computer's time per move (0: the server's default)
+//   --seed 1
+//
+// Reports games and moves per second, move latency percentiles as the client
+// sees them (MOVE sent to REPLY received) and errors, then the server's own
+// figures from a STATS request.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "tools/protocol.h"
+
+using namespace std;
+
+// ---------- Options ----------
+struct LoadOptions {
+    string host = "127.0.0.1";
+    int port = 7878;
+    string unixPath;
+    int connections = 4;
+    int games = 256;      // per connection
+    int size = 3, inRow = 0;
+    int moveMs = 0;
+    double seconds = 10;
+    unsigned long long seed = 1;
+};
+
+int connectTo(const LoadOptions &o) {
+    int fd;
+    if (!o.unixPath.empty()) {
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, o.unixPath.c_str(), sizeof(addr.sun_path) - 1);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) return fd;
+    } else {
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((unsigned short)o.port);
+        inet_pton(AF_INET, o.host.c_str(), &addr.sin_addr);
+        fd = socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        if (fd >= 0) setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        if (fd >= 0 && connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0) return fd;
+    }
+    if (fd >= 0) close(fd);
+    return -1;
+}
+
+bool sendAll(int fd, vector<unsigned char> &out) {
+    size_t sent = 0;
+    while (sent < out.size()) {
+        ssize_t n = send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    out.clear();
+    return true;
+}
+
+// ---------- Clients ----------
+// splitmix64, as in selfplay
+struct Rng {
+    unsigned long long x;
+    explicit Rng(unsigned long long seed) : x(seed) {}
+    unsigned long long next() {
+        unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return (int)(next() % (unsigned long long)n); }
+};
+
+struct ClientGame {
+    Game board;                  // the client's copy of the game
+    unsigned int id = 0;         // server's game id, 0 until GAME arrives
+    chrono::steady_clock::time_point sent;
+};
+
+struct LoadStats {
+    long long games = 0, moves = 0, errors = 0;
+    vector<float> latencyUs;
+    bool failed = false;         // connection lost
+};
+
+// One connection: keeps o.games games going until the deadline, then lets
+// the ones in flight finish
+void runConnection(const LoadOptions &o, int index, chrono::steady_clock::time_point deadline, LoadStats &stats) {
+    int fd = connectTo(o);
+    if (fd < 0) { stats.failed = true; return; }
+    const int k = o.inRow ? o.inRow : o.size;
+    Rng rng(o.seed * 0x100000001B3ULL + index);
+    vector<ClientGame> games(o.games);
+    vector<unsigned char> out, in;
+    auto startGame = [&](int tag) {
+        games[tag].board.reset(o.size, o.size, k);
+        games[tag].id = 0;
+        FrameWriter(out, MSG_NEW_GAME).u32(tag).u8(o.size).u8(o.size).u8(k).u16(o.moveMs);
+    };
+    auto sendMove = [&](ClientGame &g) {
+        int moves[MAX_CELLS] = {};
+        int cell = moves[rng.below(g.board.legalMoves(moves))];
+        g.board.play(cell);
+        g.sent = chrono::steady_clock::now();
+        FrameWriter(out, MSG_MOVE).u32(g.id).u8(cell);
+    };
+    for (int t=0;t<o.games;t++) startGame(t);
+    int inFlight = o.games;
+    vector<int> tagOf;   // server game id slot -> tag, for REPLY
+    unsigned char buf[65536];
+    while (inFlight > 0) {
+        if (!sendAll(fd, out)) { stats.failed = true; break; }
+        ssize_t got = read(fd, buf, sizeof(buf));
+        if (got <= 0) { stats.failed = true; break; }
+        in.insert(in.end(), buf, buf + got);
+        const bool stopping = chrono::steady_clock::now() >= deadline;
+        size_t pos = 0;
+        for (int length; (length = frameLength(in.data() + pos, in.size() - pos)) > 0; pos += length) {
+            FrameReader r(in.data() + pos + 2, length - 2);
+            const unsigned int type = r.u8();
+            if (type == MSG_GAME) {
+                unsigned int tag = r.u32(), id = r.u32(), status = r.u8();
+                if (status != STATUS_OK || tag >= games.size()) { stats.errors++; inFlight--; continue; }
+                games[tag].id = id;
+                if ((id & 0xFFFF) >= tagOf.size()) tagOf.resize((id & 0xFFFF) + 1, -1);
+                tagOf[id & 0xFFFF] = tag;
+                sendMove(games[tag]);
+            } else if (type == MSG_REPLY) {
+                unsigned int id = r.u32(), status = r.u8(), reply = r.u8(), result = r.u8();
+                if ((id & 0xFFFF) >= tagOf.size() || tagOf[id & 0xFFFF] < 0) { stats.errors++; continue; }
+                ClientGame &g = games[tagOf[id & 0xFFFF]];
+                stats.latencyUs.push_back((float)chrono::duration<double, micro>(chrono::steady_clock::now() - g.sent).count());
+                stats.moves++;
+                if (status != STATUS_OK) stats.errors++;
+                if (reply != NO_CELL) g.board.play(reply);
+                if (result != RESULT_NONE || g.board.over) {
+                    stats.games++;
+                    FrameWriter(out, MSG_END).u32(id);
+                    tagOf[id & 0xFFFF] = -1;
+                    if (stopping) inFlight--;
+                    else startGame((int)(&g - games.data()));
+                } else if (stopping) {
+                    FrameWriter(out, MSG_END).u32(id);
+                    tagOf[id & 0xFFFF] = -1;
+                    inFlight--;
+                } else {
+                    sendMove(g);
+                }
+            }
+            // ENDED needs nothing
+        }
+        if (frameLength(in.data() + pos, in.size() - pos) < 0) { stats.failed = true; break; }
+        in.erase(in.begin(), in.begin() + pos);
+    }
+    sendAll(fd, out);
+    close(fd);
+}
+
+float percentile(vector<float> &v, double q) {
+    if (v.empty()) return 0;
+    size_t k = min(v.size() - 1, (size_t)(q * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// The server's STATS, on a connection of its own
+void printServerStats(const LoadOptions &o) {
+    int fd = connectTo(o);
+    if (fd < 0) return;
+    vector<unsigned char> out, in;
+    FrameWriter(out, MSG_STATS);
+    unsigned char buf[256];
+    int length = 0;
+    if (sendAll(fd, out)) {
+        while ((length = frameLength(in.data(), in.size())) == 0) {
+            ssize_t got = read(fd, buf, sizeof(buf));
+            if (got <= 0) break;
+            in.insert(in.end(), buf, buf + got);
+        }
+    }
+    close(fd);
+    if (length <= 0) return;
+    FrameReader r(in.data() + 2, length - 2);
+    if (r.u8() != MSG_STATS_REPLY) return;
+    unsigned int sessions = r.u32(), waiting = r.u32();
+    unsigned long long moves = r.u64();
+    unsigned int perSec = r.u32(), p50 = r.u32(), p99 = r.u32();
+    printf("server: sessions=%u waiting=%u moves=%llu  last second: moves/sec=%u p50=%.3fms p99=%.3fms\n",
+           sessions, waiting, moves, perSec, p50 / 1000.0, p99 / 1000.0);
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    LoadOptions o;
+    for (int i=1;i<argc;i++) {
+        bool more = i+1 < argc;
+        if (strcmp(argv[i], "--host") == 0 && more) o.host = argv[++i];
+        else if (strcmp(argv[i], "--port") == 0 && more) o.port = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--unix") == 0 && more) o.unixPath = argv[++i];
+        else if (strcmp(argv[i], "--connections") == 0 && more) o.connections = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--games") == 0 && more) o.games = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--size") == 0 && more) o.size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--k") == 0 && more) o.inRow = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--move-ms") == 0 && more) o.moveMs = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seconds") == 0 && more) o.seconds = max(0.1, atof(argv[++i]));
+        else if (strcmp(argv[i], "--seed") == 0 && more) o.seed = strtoull(argv[++i], nullptr, 10);
+        else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+    }
+    if (!validShape(o.size, o.size, o.inRow ? o.inRow : o.size)) { fprintf(stderr, "unsupported board\n"); return 1; }
+
+    printf("%d connections x %d games, %dx%d, %.1fs\n", o.connections, o.games, o.size, o.size, o.seconds);
+    vector<LoadStats> perConn(o.connections);
+    vector<thread> clients;
+    const auto start = chrono::steady_clock::now();
+    const auto deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(o.seconds));
+    for (int c=0;c<o.connections;c++)
+        clients.emplace_back([&, c]{ runConnection(o, c, deadline, perConn[c]); });
+    for (auto &t : clients) t.join();
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    LoadStats total;
+    int failed = 0;
+    for (auto &s : perConn) {
+        total.games += s.games;
+        total.moves += s.moves;
+        total.errors += s.errors;
+        failed += s.failed;
+        total.latencyUs.insert(total.latencyUs.end(), s.latencyUs.begin(), s.latencyUs.end());
+    }
+    printf("client: games=%lld (%.0f/sec) moves=%lld (%.0f/sec) p50=%.3fms p90=%.3fms p99=%.3fms max=%.3fms errors=%lld%s\n",
+           total.games, total.games / sec, total.moves, total.moves / sec,
+           percentile(total.latencyUs, 0.50) / 1000, percentile(total.latencyUs, 0.90) / 1000,
+           percentile(total.latencyUs, 0.99) / 1000, percentile(total.latencyUs, 1.0) / 1000, total.errors,
+           failed ? "  (some connections failed)" : "");
+    printServerStats(o);
+    return failed || total.errors ? 1 : 0;
+}
@@ -0,0 +1,96 @@
+// File: tools/protocol.h
+// Wire format between tictactoe-server and its clients (tools/loadgen.cpp).
+// Every message is a frame: a little-endian u16 with the number of bytes that
+// follow, then a u8 type and its fields, little-endian, no padding.
+//
+//   client -> server                          server -> client
+//   NEW_GAME u32 tag u8 rows u8 cols u8 k     GAME   u32 tag u32 game u8 status
+//            u16 moveMs (0: server default)
+//   MOVE     u32 game u8 cell                 REPLY  u32 game u8 status u8 reply u8 result
+//   END      u32 game                         ENDED  u32 game u8 status
+//   STATS                                     STATS  u32 sessions u32 queued u64 moves
+//                                                    u32 movesPerSec u32 p50us u32 p99us
+//
+// The client plays X. A MOVE is answered once the computer (O) has replied:
+// reply is its cell (NO_CELL if the game ended first, or on an error) and
+// result a BoardResult. Moves for one game may be sent ahead; they queue on
+// that game, and a full queue answers BUSY.
+#pragma once
+
+#include <cstring>
+#include <vector>
+
+#include "engine/evaluate.h"   // BoardResult
+
+using namespace std;
+
+// ---------- Messages ----------
+enum MessageType : unsigned char {
+    MSG_NEW_GAME = 1, MSG_MOVE = 2, MSG_END = 3, MSG_STATS = 4,
+    MSG_GAME = 0x81, MSG_REPLY = 0x82, MSG_ENDED = 0x83, MSG_STATS_REPLY = 0x84,
+};
+
+enum MessageStatus : unsigned char {
+    STATUS_OK = 0,
+    STATUS_ILLEGAL = 1,      // occupied or off-board cell, or not X's turn
+    STATUS_NO_GAME = 2,      // unknown or finished game id
+    STATUS_BUSY = 3,         // the game's move queue is full
+    STATUS_FULL = 4,         // no free session
+    STATUS_BAD_SHAPE = 5,    // board the engine does not support
+    STATUS_GAME_OVER = 6,
+};
+
+const unsigned char NO_CELL = 255;
+const int MAX_FRAME = 64;   // longer frames are a protocol error
+
+// ---------- Encoding ----------
+// Appends one frame at a time to a byte buffer
+class FrameWriter {
+private:
+    vector<unsigned char> &out;
+    size_t start;
+
+public:
+    FrameWriter(vector<unsigned char> &buffer, MessageType type) : out(buffer), start(buffer.size()) {
+        out.push_back(0);
+        out.push_back(0);
+        out.push_back(type);
+    }
+    ~FrameWriter() {
+        const size_t length = out.size() - start - 2;
+        out[start] = (unsigned char)(length & 255);
+        out[start + 1] = (unsigned char)(length >> 8);
+    }
+    FrameWriter& u8(unsigned int v) { out.push_back((unsigned char)v); return *this; }
+    FrameWriter& u16(unsigned int v) { return u8(v & 255).u8(v >> 8 & 255); }
+    FrameWriter& u32(unsigned int v) { return u16(v & 0xFFFF).u16(v >> 16); }
+    FrameWriter& u64(unsigned long long v) { return u32((unsigned int)v).u32((unsigned int)(v >> 32)); }
+};
+
+// Reads the fields of one frame; reading past its end yields zeros and sets bad
+class FrameReader {
+private:
+    const unsigned char* p;
+    const unsigned char* end;
+
+public:
+    bool bad = false;
+
+    FrameReader(const unsigned char* body, size_t length) : p(body), end(body + length) {}
+    unsigned int u8() {
+        if (p >= end) { bad = true; return 0; }
+        return *p++;
+    }
+    unsigned int u16() { unsigned int lo = u8(); return lo | u8() << 8; }
+    unsigned int u32() { unsigned int lo = u16(); return lo | u16() << 16; }
+    unsigned long long u64() { unsigned long long lo = u32(); return lo | (unsigned long long)u32() << 32; }
+};
+
+// Length of the frame at the front of buf (prefix included), or 0 if it
+// has not fully arrived; -1 if the prefix is out of range
+inline int frameLength(const unsigned char* buf, size_t available) {
+    if (available < 2) return 0;
+    const int length = buf[0] | buf[1] << 8;
+    if (length < 1 || length > MAX_FRAME) return -1;
+    return available >= (size_t)length + 2 ? length + 2 : 0;
+}
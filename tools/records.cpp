@@ -0,0 +1,174 @@
+// File: tools/records.cpp
+// Reads the game archives that the game (--record) and tictactoe-selfplay
+// --record append to (engine/record.h).
+// g++ -O2 -I. tools/records.cpp -o tictactoe-records -pthread
+//
+//   tictactoe-records stats tictactoe.games     games per board: results, lengths, modes
+//   tictactoe-records verify tictactoe.games    replays every game against the rules and
+//                                               rescores the final boards in bulk
+//   tictactoe-records show tictactoe.games 12   game 12, board by board
+//   --no-verify                                 skip the block checksums
+//
+// Each command reports how long the pass over the archive took.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "engine/record.h"
+
+using namespace std;
+
+// ---------- Commands ----------
+struct ShapeStats {
+    long long games = 0, plies = 0;
+    long long results[4] = {};   // by BoardResult
+    long long modes[RECORD_MODES] = {};
+};
+
+int runStats(GameArchive &archive, bool verify) {
+    map<int, ShapeStats> shapes;   // (rows, cols, k) packed
+    const auto start = chrono::steady_clock::now();
+    const long long games = archive.forEach([&](const GameRecordView &g) {
+        ShapeStats &s = shapes[(g.rows*(MAX_N+1) + g.cols)*(MAX_N+1) + g.k];
+        s.games++;
+        s.plies += g.moveCount;
+        s.results[g.result & 3]++;
+        s.modes[g.mode]++;
+    }, verify);
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%lld games in %lld blocks (%lld bad), %.1f MB, read in %.3fs: %.0f games/sec, %.0f MB/s\n",
+           games, archive.blocks, archive.badBlocks, archive.bytes() / 1e6, sec,
+           games / max(sec, 1e-9), archive.bytes() / 1e6 / max(sec, 1e-9));
+    printf("%-12s %10s %8s %8s %8s %8s %8s  %s\n", "board", "games", "X win%", "O win%", "draw%", "open%", "plies", "modes");
+    for (auto &entry : shapes) {
+        const int k = entry.first % (MAX_N+1), cols = entry.first / (MAX_N+1) % (MAX_N+1), rows = entry.first / (MAX_N+1) / (MAX_N+1);
+        const ShapeStats &s = entry.second;
+        char shape[32];
+        snprintf(shape, sizeof(shape), "%dx%d k=%d", rows, cols, k);
+        printf("%-12s %10lld %8.2f %8.2f %8.2f %8.2f %8.2f ", shape, s.games,
+               100.0 * s.results[RESULT_X_WINS] / s.games, 100.0 * s.results[RESULT_O_WINS] / s.games,
+               100.0 * s.results[RESULT_DRAW] / s.games, 100.0 * s.results[RESULT_NONE] / s.games,
+               (double)s.plies / s.games);
+        for (int m=0;m<RECORD_MODES;m++)
+            if (s.modes[m]) printf(" %s=%lld", RECORD_MODE_NAMES[m], s.modes[m]);
+        printf("\n");
+    }
+    return archive.badBlocks ? 1 : 0;
+}
+
+// Final boards of one shape, scored BATCH at a time by BatchEvaluator
+// independently of the Game that replayed them
+struct ResultBatch {
+    static const int BATCH = 1024;
+    BatchEvaluator eval;
+    vector<unsigned long long> x, o;
+    vector<signed char> recorded, result;
+    vector<int> heuristic;
+
+    ResultBatch(int rows, int cols, int k) : eval(rows, cols, k) {}
+
+    // Games whose recorded result the board doesn't show
+    long long add(const Position &pos, int recordedResult) {
+        x.push_back(pos.bb[1].w[0]);
+        o.push_back(pos.bb[2].w[0]);
+        recorded.push_back((signed char)recordedResult);
+        return (int)x.size() == BATCH ? flush() : 0;
+    }
+
+    long long flush() {
+        const int count = (int)x.size();
+        result.resize(count);
+        heuristic.resize(count);
+        eval.evaluate(x.data(), o.data(), count, result.data(), heuristic.data());
+        long long wrong = 0;
+        for (int i=0;i<count;i++) wrong += result[i] != recorded[i];
+        x.clear();
+        o.clear();
+        recorded.clear();
+        return wrong;
+    }
+};
+
+// Every game must be legal, and its recorded result must be the board's
+int runVerify(GameArchive &archive, bool verify) {
+    long long illegal = 0, wrongResult = 0;
+    Game replay;
+    map<int, unique_ptr<ResultBatch>> batches;   // (rows, cols, k) packed, boards of up to 64 cells
+    const auto start = chrono::steady_clock::now();
+    const long long games = archive.forEach([&](const GameRecordView &g) {
+        if (!replayRecord(g, replay)) { illegal++; return; }
+        if (!BatchEvaluator::fits(g.rows, g.cols)) {
+            if (gameResult(replay) != g.result) wrongResult++;
+            return;
+        }
+        unique_ptr<ResultBatch> &b = batches[(g.rows*(MAX_N+1) + g.cols)*(MAX_N+1) + g.k];
+        if (!b) b.reset(new ResultBatch(g.rows, g.cols, g.k));
+        wrongResult += b->add(replay.pos, g.result);
+    }, verify);
+    for (auto &entry : batches) wrongResult += entry.second->flush();
+    const double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    printf("%lld games replayed in %.3fs (%.0f games/sec), results rescored with %s: "
+           "%lld illegal, %lld with the wrong result, %lld bad blocks\n",
+           games, sec, games / max(sec, 1e-9), EVAL_KERNEL_NAMES[bestEvalKernel()], illegal, wrongResult, archive.badBlocks);
+    return illegal || wrongResult || archive.badBlocks ? 1 : 0;
+}
+
+void printBoard(const Game &g) {
+    const Position &pos = g.pos;
+    for (int i=0;i<pos.rows;i++) {
+        printf("  ");
+        for (int j=0;j<pos.cols;j++) printf(" %c", ".XO"[pos.cellAt(i*pos.cols + j)]);
+        printf("\n");
+    }
+}
+
+int runShow(GameArchive &archive, long long index, bool verify) {
+    if (archive.index(verify) <= index || index < 0) {
+        fprintf(stderr, "no game %lld (the archive has %lld)\n", index, archive.indexedGames());
+        return 1;
+    }
+    const GameRecordView g = archive.game(index);
+    static const char* const RESULTS[4] = {"unfinished", "X wins", "O wins", "draw"};
+    printf("game %lld: %dx%d, %d in a row, %s, %d moves, %s\n", index, g.rows, g.cols, g.k,
+           RECORD_MODE_NAMES[g.mode], g.moveCount, RESULTS[g.result & 3]);
+    Game replay;
+    for (int ply=1;ply<=g.moveCount;ply++) {
+        if (!replayRecord(g, replay, ply)) { printf("move %d is illegal\n", ply); return 1; }
+        const int cell = g.moves[ply - 1];
+        printf("%d. %c (%d,%d)\n", ply, ply % 2 ? 'X' : 'O', cell / g.cols, cell % g.cols);
+        printBoard(replay);
+    }
+    return 0;
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    const char* command = nullptr;
+    const char* path = nullptr;
+    long long index = -1;
+    bool verify = true;
+    for (int i=1;i<argc;i++) {
+        if (strcmp(argv[i], "--no-verify") == 0) verify = false;
+        else if (!command) command = argv[i];
+        else if (!path) path = argv[i];
+        else if (index < 0) index = atoll(argv[i]);
+        else { fprintf(stderr, "unexpected %s\n", argv[i]); return 1; }
+    }
+    if (!command || !path) {
+        fprintf(stderr, "usage: tictactoe-records stats|verify|show FILE [GAME] [--no-verify]\n");
+        return 1;
+    }
+    GameArchive archive;
+    if (!archive.open(path)) { fprintf(stderr, "%s is not a game archive\n", path); return 1; }
+    if (strcmp(command, "stats") == 0) return runStats(archive, verify);
+    if (strcmp(command, "verify") == 0) return runVerify(archive, verify);
+    if (strcmp(command, "show") == 0) return runShow(archive, max(0LL, index), verify);
+    fprintf(stderr, "unknown command %s\n", command);
+    return 1;
+}
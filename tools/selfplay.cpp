@@ -0,0 +1,219 @@
+// File: tools/selfplay.cpp
+// Headless self-play: engine against a random player or against itself, on
+// every core, for each board size and search depth asked for.
+// g++ -O2 -I. tools/selfplay.cpp -o tictactoe-selfplay -pthread
+//
+//   tictactoe-selfplay --games 100000 --sizes 3,4 --depths 1,2,full --opponent random
+//   --opponent engine   both sides search; the first --random-plies moves are random
+//   --threads 8         games in flight at once (default: all hardware threads)
+//   --seed 7            games are reproducible per seed, whatever the thread count
+//   --tt-mb 64          shared transposition table
+//   --k 5               marks in a row to win (default: the whole side), e.g. --sizes 15 --k 5
+//   --record games.tttr append every game to a game archive (tictactoe-records reads it)
+//
+// Per size and depth it reports games/sec, the result rates, average nodes per
+// engine move and engine move latency percentiles. Against the random player the
+// rates are the engine's (it takes X and O in turn); in engine mode they are X's.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "engine/engine.h"
+
+using namespace std;
+
+// ---------- Options ----------
+struct SelfPlayOptions {
+    long long games = 10000;            // per size and depth
+    vector<int> sizes = {3};
+    vector<int> depths = {1, 3, MAX_CELLS};
+    bool vsEngine = false;
+    int randomPlies = 2;                 // engine mode only
+    int inRow = 0;                       // k; 0 = the board's side
+    int threads = max(1u, thread::hardware_concurrency());
+    unsigned long long seed = 1;
+    GameRecordWriter* archive = nullptr;   // --record
+};
+
+// "1,2,full" -> {1, 2, MAX_CELLS}; false on anything else
+bool parseList(const char* text, vector<int> &out, bool allowFull) {
+    out.clear();
+    for (const char* p = text; *p; ) {
+        const char* end = strchr(p, ',');
+        string item(p, end ? end - p : strlen(p));
+        if (allowFull && item == "full") out.push_back(MAX_CELLS);
+        else if (!item.empty() && item.find_first_not_of("0123456789") == string::npos) out.push_back(atoi(item.c_str()));
+        else return false;
+        if (!end) break;
+        p = end + 1;
+    }
+    return !out.empty();
+}
+
+// ---------- Games ----------
+// splitmix64: one independent stream per game, so a game doesn't depend on which thread plays it
+struct GameRng {
+    unsigned long long x;
+    explicit GameRng(unsigned long long seed) : x(seed) {}
+    unsigned long long next() {
+        unsigned long long z = (x += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+    int below(int n) { return (int)(next() % (unsigned long long)n); }
+};
+
+struct SelfPlayStats {
+    long long games = 0, wins = 0, draws = 0, losses = 0;
+    long long engineMoves = 0, nodes = 0;
+    vector<float> latencyUs;   // one entry per engine move
+};
+
+// Plays game number index and adds it to stats, and to the block when recording
+void playGame(const SelfPlayOptions &o, int n, int depth, long long index, SelfPlayStats &stats, GameRecordBlock &block) {
+    GameRng rng(o.seed * 0x100000001B3ULL + index);
+    Game g(n, n, o.inRow ? o.inRow : n);
+    GameRecord record;
+    record.start(n, n, g.pos.k, RECORD_SELF_PLAY);
+    const int engineSide = index % 2 == 0 ? 2 : 1;   // against the random player
+    int moves[MAX_CELLS];
+    for (int ply = 0; !g.over; ply++) {
+        bool engineMove = o.vsEngine ? ply >= o.randomPlies : g.toMove == engineSide;
+        int cell;
+        if (engineMove) {
+            auto start = chrono::steady_clock::now();
+            SearchResult r = findBestMoveFor(g.pos, g.toMove, depth);
+            stats.latencyUs.push_back((float)chrono::duration<double, micro>(chrono::steady_clock::now() - start).count());
+            stats.engineMoves++;
+            stats.nodes += r.nodes;
+            cell = r.cell;
+        } else {
+            cell = moves[rng.below(g.legalMoves(moves))];
+        }
+        g.play(cell);
+        record.add(cell);
+    }
+    if (o.archive) {
+        record.result = gameResult(g);
+        block.add(record);
+        if (block.full()) o.archive->appendBlock(block);
+    }
+    const int side = o.vsEngine ? 1 : engineSide;
+    stats.games++;
+    if (g.winner == 0) stats.draws++;
+    else if (g.winner == side) stats.wins++;
+    else stats.losses++;
+}
+
+// All games of one size and depth, handed out in chunks to the worker threads
+SelfPlayStats playBatch(const SelfPlayOptions &o, int n, int depth) {
+    const long long CHUNK = 64;
+    atomic<long long> next{0};
+    vector<SelfPlayStats> perThread(o.threads);
+    vector<thread> workers;
+    for (int t=0;t<o.threads;t++) {
+        workers.emplace_back([&, t]() {
+            GameRecordBlock block;   // this thread's games, written a block at a time
+            for (;;) {
+                long long first = next.fetch_add(CHUNK);
+                if (first >= o.games) break;
+                for (long long i = first; i < min(first + CHUNK, o.games); i++) playGame(o, n, depth, i, perThread[t], block);
+            }
+            if (o.archive) o.archive->appendBlock(block);
+        });
+    }
+    for (auto &w : workers) w.join();
+    SelfPlayStats total;
+    for (auto &s : perThread) {
+        total.games += s.games;
+        total.wins += s.wins;
+        total.draws += s.draws;
+        total.losses += s.losses;
+        total.engineMoves += s.engineMoves;
+        total.nodes += s.nodes;
+        total.latencyUs.insert(total.latencyUs.end(), s.latencyUs.begin(), s.latencyUs.end());
+    }
+    return total;
+}
+
+float percentile(vector<float> &v, double q) {
+    if (v.empty()) return 0;
+    size_t k = min(v.size() - 1, (size_t)(q * v.size()));
+    nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+// ---------- Main ----------
+int main(int argc, char** argv) {
+    SelfPlayOptions o;
+    GameRecordWriter archive;
+    for (int i=1;i<argc;i++) {
+        bool more = i+1 < argc;
+        if (strcmp(argv[i], "--games") == 0 && more) o.games = max(1LL, atoll(argv[++i]));
+        else if (strcmp(argv[i], "--sizes") == 0 && more) {
+            if (!parseList(argv[++i], o.sizes, false)) { fprintf(stderr, "bad --sizes\n"); return 1; }
+        }
+        else if (strcmp(argv[i], "--depths") == 0 && more) {
+            if (!parseList(argv[++i], o.depths, true)) { fprintf(stderr, "bad --depths\n"); return 1; }
+        }
+        else if (strcmp(argv[i], "--opponent") == 0 && more) {
+            const char* who = argv[++i];
+            if (strcmp(who, "engine") != 0 && strcmp(who, "random") != 0) { fprintf(stderr, "bad --opponent\n"); return 1; }
+            o.vsEngine = strcmp(who, "engine") == 0;
+        }
+        else if (strcmp(argv[i], "--random-plies") == 0 && more) o.randomPlies = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--threads") == 0 && more) o.threads = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--seed") == 0 && more) o.seed = strtoull(argv[++i], nullptr, 10);
+        else if (strcmp(argv[i], "--tt-mb") == 0 && more) transTable.resize(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--k") == 0 && more) o.inRow = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--record") == 0 && more) {
+            const char* path = argv[++i];
+            if (!archive.open(path)) { fprintf(stderr, "cannot append to %s\n", path); return 1; }
+            o.archive = &archive;
+        }
+        else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+    }
+    for (int n : o.sizes) {
+        if (n < 3 || n > MAX_N) { fprintf(stderr, "sizes must be 3..%d\n", MAX_N); return 1; }
+        if (o.inRow && !validShape(n, n, o.inRow)) { fprintf(stderr, "--k must be 3..%d\n", n); return 1; }
+    }
+
+    char inRowText[16] = "full side";
+    if (o.inRow) snprintf(inRowText, sizeof(inRowText), "%d", o.inRow);
+    printf("self-play: %lld games per row, %s in a row, opponent %s, %d threads, seed %llu\n",
+           o.games, inRowText, o.vsEngine ? "engine" : "random", o.threads, o.seed);
+    printf("%-5s %-5s %12s %8s %8s %8s %12s %10s %10s %10s %10s\n", "size", "depth", "games/sec",
+           o.vsEngine ? "X win%" : "win%", "draw%", o.vsEngine ? "O win%" : "loss%",
+           "nodes/move", "p50 us", "p90 us", "p99 us", "max us");
+    for (int n : o.sizes) {
+        for (int depth : o.depths) {
+            transTable.clear();
+            auto start = chrono::steady_clock::now();
+            SelfPlayStats s = playBatch(o, n, depth);
+            double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            char depthText[16] = "full";
+            if (depth < MAX_CELLS) snprintf(depthText, sizeof(depthText), "%d", depth);
+            printf("%-5d %-5s %12.0f %8.2f %8.2f %8.2f %12.1f %10.1f %10.1f %10.1f %10.1f\n",
+                   n, depthText, s.games / max(sec, 1e-9),
+                   100.0 * s.wins / s.games, 100.0 * s.draws / s.games, 100.0 * s.losses / s.games,
+                   (double)s.nodes / max(s.engineMoves, 1LL),
+                   percentile(s.latencyUs, 0.50), percentile(s.latencyUs, 0.90),
+                   percentile(s.latencyUs, 0.99), percentile(s.latencyUs, 1.0));
+            fflush(stdout);
+        }
+    }
+    if (o.archive) {
+        const bool written = archive.close();
+        printf("recorded %lld games, %.1f MB\n", archive.gamesWritten(), archive.bytesWritten() / 1e6);
+        if (!written) { fprintf(stderr, "writing the game archive failed; it ends early\n"); return 1; }
+    }
+    return 0;
+}
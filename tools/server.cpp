@@ -0,0 +1,604 @@
+// File: tools/server.cpp
+// Headless game server: many games at once against the engine, over TCP and/or
+// a Unix-domain socket, with the binary protocol of tools/protocol.h. Linux only
+// (epoll, eventfd).
+// g++ -O2 -I. tools/server.cpp -o tictactoe-server -pthread
+//
+//   tictactoe-server --port 7878 --unix /tmp/tictactoe.sock --workers 8
+//   --port 0             no TCP listener (default 7878, on --host, default 127.0.0.1)
+//   --max-sessions 16384 games open at once, at most 65536
+//   --queue 8            moves that may wait on one game
+//   --jobs 1024          searches queued for the workers at once
+//   --move-ms 50         computer's time per move unless NEW_GAME asks otherwise
+//   --tt-mb 64           shared transposition table
+//   --cache path         search cache file, shareable by several servers (--cache-mb 64 when created)
+//
+// One thread runs the event loop: it parses requests, plays the client's moves
+// and answers. The computer's moves are searched by the worker pool, serially
+// per search; a game waits for its reply before its next queued move is
+// played. Every second it prints open sessions, moves/sec and move latency
+// percentiles (from a move arriving to its reply being queued for sending).
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <csignal>
+#include <chrono>
+#include <vector>
+#include <deque>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <memory>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "engine/engine.h"
+#include "tools/protocol.h"
+
+using namespace std;
+
+// ---------- Options ----------
+struct ServerOptions {
+    string host = "127.0.0.1";
+    int port = 7878;
+    string unixPath;
+    int workers = max(1u, thread::hardware_concurrency());
+    int maxSessions = 16384;
+    int queueDepth = 8;
+    int jobs = 1024;
+    int moveMs = 50;
+};
+
+const int MAX_QUEUE = 32;   // upper bound for --queue
+
+// ---------- Worker pool ----------
+// A search for one game. The loop fills a free job, the worker sets cell.
+struct Job {
+    unsigned int session;
+    int moveMs;
+    Position pos;
+    int cell;
+};
+
+class WorkerPool {
+private:
+    vector<thread> threads;
+    mutex m;
+    condition_variable ready;
+    deque<Job*> pending;
+    vector<Job*> done;   // handed back to the loop through notifyFd
+    bool quit = false;
+    int notifyFd;
+
+    void work() {
+        for (;;) {
+            Job* job;
+            {
+                unique_lock<mutex> lock(m);
+                ready.wait(lock, [&]{ return quit || !pending.empty(); });
+                if (quit) return;
+                job = pending.front();
+                pending.pop_front();
+            }
+            SearchControl control;
+            control.timeLimit = job->moveMs / 1000.0;
+            control.start();
+            job->cell = searchBestMove(job->pos, &control).cell;
+            if (job->cell < 0) job->cell = lowestBit(job->pos.playableCells());
+            {
+                lock_guard<mutex> lock(m);
+                done.push_back(job);
+            }
+            unsigned long long one = 1;
+            ssize_t ignored = write(notifyFd, &one, sizeof(one));
+            (void)ignored;
+        }
+    }
+
+public:
+    explicit WorkerPool(int count) : notifyFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        for (int i=0;i<count;i++) threads.emplace_back([this]{ work(); });
+    }
+    ~WorkerPool() {
+        { lock_guard<mutex> lock(m); quit = true; }
+        ready.notify_all();
+        for (auto &t : threads) t.join();
+        close(notifyFd);
+    }
+
+    int fd() const { return notifyFd; }
+
+    void submit(Job* job) {
+        { lock_guard<mutex> lock(m); pending.push_back(job); }
+        ready.notify_one();
+    }
+
+    // Finished jobs since the last call, into out (cleared first)
+    void collect(vector<Job*> &out) {
+        unsigned long long count;
+        ssize_t ignored = read(notifyFd, &count, sizeof(count));
+        (void)ignored;
+        out.clear();
+        lock_guard<mutex> lock(m);
+        out.swap(done);
+    }
+};
+
+// ---------- Sessions ----------
+struct QueuedMove {
+    unsigned char cell;
+    chrono::steady_clock::time_point arrived;
+};
+
+struct Session {
+    Game* game = nullptr;      // from the pool; nullptr when the slot is free
+    unsigned int id = 0;       // slot | generation << 16
+    int conn = -1;             // owning connection's fd, -1 once it has closed
+    unsigned long long connSerial = 0;
+    int connIndex = -1;        // its place in the connection's slots list
+    int moveMs = 0;
+    bool searching = false;    // a job for it is with the workers
+    bool waiting = false;      // in Server::waitingForJob
+    QueuedMove queue[MAX_QUEUE];
+    int head = 0, queued = 0;
+};
+
+struct Connection {
+    int fd;
+    unsigned long long serial;   // tells a reused fd from the connection a session belongs to
+    vector<unsigned char> in, out;
+    size_t outSent = 0;
+    bool writable = true;        // false while waiting for EPOLLOUT
+    bool inputClosed = false;    // the client shut down its side: answer what it sent, then close
+    vector<int> slots;           // pool slots of its open sessions
+};
+
+// ---------- Server ----------
+class Server {
+private:
+    ServerOptions o;
+    int epollFd = -1;
+    vector<int> listeners;
+    int spareFd = -1;                        // given up to accept and drop a client when out of fds
+    vector<unique_ptr<Connection>> conns;   // by fd
+    unsigned long long nextSerial = 1;
+    vector<int> dirty;                       // connections with output to flush
+
+    GamePool pool;
+    vector<Session> sessions;               // by pool slot
+    vector<unsigned short> generations;
+    int openSessions = 0;
+
+    WorkerPool workers;
+    unique_ptr<Job[]> jobs;
+    vector<Job*> freeJobs;
+    deque<unsigned int> waitingForJob;      // sessions with a move to search but no free job
+    vector<Job*> finished;
+
+    // Stats: totals, and latencies of the current one-second interval
+    unsigned long long moves = 0, intervalMoves = 0, refused = 0;
+    vector<float> latencyUs;
+    unsigned int lastMovesPerSec = 0, lastP50 = 0, lastP99 = 0;
+    chrono::steady_clock::time_point intervalStart;
+
+    // ---------- Connections ----------
+    void watch(int fd, unsigned int events, int op) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        epoll_ctl(epollFd, op, fd, &ev);
+    }
+
+    static void nonBlocking(int fd) { fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK); }
+
+    bool listenOn(int fd, const sockaddr* addr, socklen_t len, const char* what) {
+        int yes = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+        if (fd < 0 || bind(fd, addr, len) < 0 || listen(fd, 1024) < 0) {
+            fprintf(stderr, "cannot listen on %s: %s\n", what, strerror(errno));
+            if (fd >= 0) close(fd);
+            return false;
+        }
+        nonBlocking(fd);
+        listeners.push_back(fd);
+        watch(fd, EPOLLIN, EPOLL_CTL_ADD);
+        printf("listening on %s\n", what);
+        return true;
+    }
+
+    void acceptAll(int listener) {
+        for (;;) {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0 && (errno == EMFILE || errno == ENFILE) && spareFd >= 0) {
+                // Out of descriptors: the pending client would keep the listener
+                // readable and epoll_wait spinning, so take it with the spare fd
+                // and hang up on it
+                close(spareFd);
+                fd = accept(listener, nullptr, nullptr);
+                if (fd >= 0) close(fd);
+                spareFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+                if (fd < 0) return;
+                refused++;
+                continue;
+            }
+            if (fd < 0 && (errno == ECONNABORTED || errno == EINTR)) continue;
+            if (fd < 0) return;
+            int yes = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));   // fails harmlessly on Unix sockets
+            if ((size_t)fd >= conns.size()) conns.resize(fd + 1);
+            conns[fd].reset(new Connection{fd, nextSerial++, {}, {}, 0, true, false, {}});
+            watch(fd, EPOLLIN | EPOLLRDHUP, EPOLL_CTL_ADD);
+        }
+    }
+
+    void closeConnection(Connection &c) {
+        // Its games end with it; one still searching is freed when its job returns
+        for (int slot : c.slots) {
+            Session &s = sessions[slot];
+            s.conn = -1;
+            s.connIndex = -1;
+            if (!s.searching) endSession(s);
+        }
+        c.slots.clear();
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, c.fd, nullptr);
+        close(c.fd);
+        conns[c.fd].reset();
+    }
+
+    static unsigned int interest(const Connection &c) {
+        unsigned int events = c.writable ? 0u : (unsigned int)EPOLLOUT;
+        if (!c.inputClosed) events |= EPOLLIN | EPOLLRDHUP;
+        return events;
+    }
+
+    // A half-closed connection has nothing left to answer
+    bool drained(const Connection &c) {
+        if (c.outSent < c.out.size()) return false;
+        for (int slot : c.slots) {
+            const Session &s = sessions[slot];
+            if (s.searching || s.waiting || s.queued > 0) return false;
+        }
+        return true;
+    }
+
+    // The session leaves its connection's list; the last entry takes its place
+    void detach(Connection &c, Session &s) {
+        const int last = c.slots.back();
+        c.slots[s.connIndex] = last;
+        sessions[last].connIndex = s.connIndex;
+        c.slots.pop_back();
+        s.conn = -1;
+        s.connIndex = -1;
+    }
+
+    void readFrom(Connection &c) {
+        unsigned char buf[16384];
+        for (;;) {
+            ssize_t got = read(c.fd, buf, sizeof(buf));
+            if (got > 0) { c.in.insert(c.in.end(), buf, buf + got); continue; }
+            if (got < 0 && (errno == EAGAIN || errno == EINTR)) break;
+            if (got < 0) { closeConnection(c); return; }
+            // EOF: the frames already read are still played and answered
+            c.inputClosed = true;
+            watch(c.fd, interest(c), EPOLL_CTL_MOD);
+            dirty.push_back(c.fd);   // closed there once drained
+            break;
+        }
+        size_t pos = 0;
+        for (;;) {
+            int length = frameLength(c.in.data() + pos, c.in.size() - pos);
+            if (length == 0) break;
+            if (length < 0) { closeConnection(c); return; }
+            handle(c, c.in.data() + pos + 2, length - 2);
+            pos += length;
+        }
+        c.in.erase(c.in.begin(), c.in.begin() + pos);
+    }
+
+    void flush(Connection &c) {
+        while (c.outSent < c.out.size()) {
+            ssize_t sent = send(c.fd, c.out.data() + c.outSent, c.out.size() - c.outSent, MSG_NOSIGNAL);
+            if (sent > 0) { c.outSent += sent; continue; }
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent < 0 && errno == EAGAIN) {
+                if (c.writable) {
+                    c.writable = false;
+                    watch(c.fd, interest(c), EPOLL_CTL_MOD);
+                }
+                return;
+            }
+            closeConnection(c);
+            return;
+        }
+        c.out.clear();
+        c.outSent = 0;
+        if (!c.writable) {
+            c.writable = true;
+            watch(c.fd, interest(c), EPOLL_CTL_MOD);
+        }
+    }
+
+    // Output for the session's connection, if it is still open
+    Connection* owner(const Session &s) {
+        if (s.conn < 0) return nullptr;
+        Connection* c = conns[s.conn].get();
+        return c && c->serial == s.connSerial ? c : nullptr;
+    }
+
+    // ---------- Requests ----------
+    Session* sessionById(unsigned int id) {
+        unsigned int slot = id & 0xFFFF;
+        if (slot >= sessions.size()) return nullptr;
+        Session &s = sessions[slot];
+        return s.game && s.id == id ? &s : nullptr;
+    }
+
+    void handle(Connection &c, const unsigned char* body, size_t length) {
+        FrameReader r(body, length);
+        const unsigned int type = r.u8();
+        dirty.push_back(c.fd);
+        if (type == MSG_NEW_GAME) {
+            unsigned int tag = r.u32(), rows = r.u8(), cols = r.u8(), k = r.u8(), moveMs = r.u16();
+            if (r.bad) return;
+            if (!validShape(rows, cols, k)) { FrameWriter(c.out, MSG_GAME).u32(tag).u32(0).u8(STATUS_BAD_SHAPE); return; }
+            Game* g = pool.acquire(rows, cols, k);
+            if (!g) { FrameWriter(c.out, MSG_GAME).u32(tag).u32(0).u8(STATUS_FULL); return; }
+            const int slot = pool.index(g);
+            Session &s = sessions[slot];
+            s.game = g;
+            s.id = (unsigned int)slot | (unsigned int)++generations[slot] << 16;
+            s.conn = c.fd;
+            s.connSerial = c.serial;
+            s.moveMs = moveMs ? moveMs : o.moveMs;
+            s.searching = s.waiting = false;
+            s.head = s.queued = 0;
+            s.connIndex = (int)c.slots.size();
+            c.slots.push_back(slot);
+            openSessions++;
+            FrameWriter(c.out, MSG_GAME).u32(tag).u32(s.id).u8(STATUS_OK);
+        } else if (type == MSG_MOVE) {
+            unsigned int id = r.u32(), cell = r.u8();
+            if (r.bad) return;
+            Session* s = sessionById(id);
+            if (!s || owner(*s) != &c) { FrameWriter(c.out, MSG_REPLY).u32(id).u8(STATUS_NO_GAME).u8(NO_CELL).u8(RESULT_NONE); return; }
+            if (s->queued == o.queueDepth) { FrameWriter(c.out, MSG_REPLY).u32(id).u8(STATUS_BUSY).u8(NO_CELL).u8(resultOf(*s->game)); return; }
+            s->queue[(s->head + s->queued++) % MAX_QUEUE] = QueuedMove{(unsigned char)cell, chrono::steady_clock::now()};
+            advance(*s);
+        } else if (type == MSG_END) {
+            unsigned int id = r.u32();
+            if (r.bad) return;
+            Session* s = sessionById(id);
+            if (!s || owner(*s) != &c) { FrameWriter(c.out, MSG_ENDED).u32(id).u8(STATUS_NO_GAME); return; }
+            detach(c, *s);
+            if (!s->searching) endSession(*s);
+            FrameWriter(c.out, MSG_ENDED).u32(id).u8(STATUS_OK);
+        } else if (type == MSG_STATS) {
+            FrameWriter(c.out, MSG_STATS_REPLY).u32(openSessions).u32((unsigned int)waitingForJob.size())
+                .u64(moves).u32(lastMovesPerSec).u32(lastP50).u32(lastP99);
+        }
+    }
+
+    static unsigned int resultOf(const Game &g) {
+        if (!g.over) return RESULT_NONE;
+        return g.winner == 1 ? RESULT_X_WINS : g.winner == 2 ? RESULT_O_WINS : RESULT_DRAW;
+    }
+
+    void reply(Session &s, const QueuedMove &m, unsigned int status, unsigned int cell) {
+        const float us = (float)chrono::duration<double, micro>(chrono::steady_clock::now() - m.arrived).count();
+        latencyUs.push_back(us);
+        moves++;
+        intervalMoves++;
+        if (Connection* c = owner(s)) {
+            FrameWriter(c->out, MSG_REPLY).u32(s.id).u8(status).u8(cell).u8(resultOf(*s.game));
+            dirty.push_back(c->fd);
+        }
+    }
+
+    // Plays queued client moves until one needs a search (or the queue is empty)
+    void advance(Session &s) {
+        while (!s.searching && !s.waiting && s.queued > 0) {
+            const QueuedMove &m = s.queue[s.head];
+            Game &g = *s.game;
+            if (g.over || g.toMove != 1 || !g.play(m.cell)) {
+                reply(s, m, g.over ? STATUS_GAME_OVER : STATUS_ILLEGAL, NO_CELL);
+            } else if (g.over) {
+                reply(s, m, STATUS_OK, NO_CELL);
+            } else {
+                startSearch(s);
+                return;   // the move stays queued until the computer answers
+            }
+            s.head = (s.head + 1) % MAX_QUEUE;
+            s.queued--;
+        }
+    }
+
+    void startSearch(Session &s) {
+        if (freeJobs.empty()) {
+            s.waiting = true;
+            waitingForJob.push_back(s.id);
+            return;
+        }
+        Job* job = freeJobs.back();
+        freeJobs.pop_back();
+        job->session = s.id;
+        job->moveMs = s.moveMs;
+        job->pos = s.game->pos;
+        s.searching = true;
+        workers.submit(job);
+    }
+
+    void finish(Job* job) {
+        Session &s = sessions[job->session & 0xFFFF];
+        const int cell = job->cell;
+        freeJobs.push_back(job);
+        s.searching = false;
+        if (s.conn < 0) { endSession(s); return; }   // its connection or game ended meanwhile
+        const QueuedMove m = s.queue[s.head];
+        s.head = (s.head + 1) % MAX_QUEUE;
+        s.queued--;
+        s.game->play(cell);
+        reply(s, m, STATUS_OK, cell);
+        advance(s);
+    }
+
+    void endSession(Session &s) {
+        pool.release(s.game);
+        s.game = nullptr;
+        s.queued = 0;
+        openSessions--;
+    }
+
+    // Sessions that found no free job get the ones just returned, in order
+    void resumeWaiting() {
+        while (!freeJobs.empty() && !waitingForJob.empty()) {
+            unsigned int id = waitingForJob.front();
+            waitingForJob.pop_front();
+            Session* s = sessionById(id);
+            if (!s) continue;   // ended while it waited: its connection or MSG_END released it
+            s->waiting = false;
+            startSearch(*s);
+        }
+    }
+
+    void report() {
+        const double sec = chrono::duration<double>(chrono::steady_clock::now() - intervalStart).count();
+        lastMovesPerSec = (unsigned int)(intervalMoves / max(sec, 1e-9));
+        lastP50 = (unsigned int)percentile(0.50);
+        lastP99 = (unsigned int)percentile(0.99);
+        printf("sessions=%-6d moves/sec=%-8u p50=%8.3fms  p99=%8.3fms  waiting=%zu  total moves=%llu",
+               openSessions, lastMovesPerSec, lastP50 / 1000.0, lastP99 / 1000.0, waitingForJob.size(), moves);
+        if (refused) printf("  refused (out of fds)=%llu", refused);
+        printf("\n");
+        fflush(stdout);
+        latencyUs.clear();
+        intervalMoves = 0;
+        intervalStart = chrono::steady_clock::now();
+    }
+
+    float percentile(double q) {
+        if (latencyUs.empty()) return 0;
+        size_t k = min(latencyUs.size() - 1, (size_t)(q * latencyUs.size()));
+        nth_element(latencyUs.begin(), latencyUs.begin() + k, latencyUs.end());
+        return latencyUs[k];
+    }
+
+public:
+    explicit Server(const ServerOptions &options)
+        : o(options), pool(options.maxSessions), sessions(options.maxSessions),
+          generations(options.maxSessions, 0), workers(options.workers), jobs(new Job[options.jobs]) {
+        for (int i=0;i<o.jobs;i++) freeJobs.push_back(&jobs[i]);
+    }
+
+    bool open() {
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        spareFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+        watch(workers.fd(), EPOLLIN, EPOLL_CTL_ADD);
+        if (o.port > 0) {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons((unsigned short)o.port);
+            if (inet_pton(AF_INET, o.host.c_str(), &addr.sin_addr) != 1) { fprintf(stderr, "bad --host %s\n", o.host.c_str()); return false; }
+            string what = "tcp " + o.host + ":" + to_string(o.port);
+            if (!listenOn(socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0), (sockaddr*)&addr, sizeof(addr), what.c_str())) return false;
+        }
+        if (!o.unixPath.empty()) {
+            sockaddr_un addr{};
+            addr.sun_family = AF_UNIX;
+            if (o.unixPath.size() >= sizeof(addr.sun_path)) { fprintf(stderr, "--unix path too long\n"); return false; }
+            strcpy(addr.sun_path, o.unixPath.c_str());
+            unlink(o.unixPath.c_str());
+            string what = "unix " + o.unixPath;
+            if (!listenOn(socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0), (sockaddr*)&addr, sizeof(addr), what.c_str())) return false;
+        }
+        if (listeners.empty()) { fprintf(stderr, "nothing to listen on: give --port or --unix\n"); return false; }
+        return true;
+    }
+
+    void run(const atomic<bool> &stop) {
+        epoll_event events[256];
+        intervalStart = chrono::steady_clock::now();
+        while (!stop) {
+            int wait = 1000 - (int)chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - intervalStart).count();
+            int n = epoll_wait(epollFd, events, 256, max(0, wait));
+            for (int i=0;i<n;i++) {
+                const int fd = events[i].data.fd;
+                if (fd == workers.fd()) {
+                    workers.collect(finished);
+                    for (Job* job : finished) finish(job);
+                    resumeWaiting();
+                } else if (find(listeners.begin(), listeners.end(), fd) != listeners.end()) {
+                    acceptAll(fd);
+                } else if (fd < (int)conns.size() && conns[fd]) {
+                    Connection &c = *conns[fd];
+                    if (events[i].events & (EPOLLERR | EPOLLHUP)) { closeConnection(c); continue; }
+                    if (events[i].events & EPOLLOUT) flush(c);
+                    if (conns[fd] && (events[i].events & (EPOLLIN | EPOLLRDHUP))) readFrom(c);
+                }
+            }
+            for (int fd : dirty) {
+                if (fd < (int)conns.size() && conns[fd] && conns[fd]->writable) flush(*conns[fd]);
+                if (fd < (int)conns.size() && conns[fd] && conns[fd]->inputClosed && drained(*conns[fd])) closeConnection(*conns[fd]);
+            }
+            dirty.clear();
+            if (chrono::steady_clock::now() - intervalStart >= chrono::seconds(1)) report();
+        }
+        report();
+    }
+
+    ~Server() {
+        for (auto &c : conns) if (c) close(c->fd);
+        for (int fd : listeners) close(fd);
+        if (!o.unixPath.empty()) unlink(o.unixPath.c_str());
+        if (epollFd >= 0) close(epollFd);
+        if (spareFd >= 0) close(spareFd);
+    }
+};
+
+// ---------- Main ----------
+atomic<bool> stopRequested{false};
+
+void onSignal(int) { stopRequested = true; }
+
+int main(int argc, char** argv) {
+    ServerOptions o;
+    const char* cachePath = nullptr;
+    size_t cacheMb = 64;
+    for (int i=1;i<argc;i++) {
+        bool more = i+1 < argc;
+        if (strcmp(argv[i], "--host") == 0 && more) o.host = argv[++i];
+        else if (strcmp(argv[i], "--port") == 0 && more) o.port = max(0, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--unix") == 0 && more) o.unixPath = argv[++i];
+        else if (strcmp(argv[i], "--workers") == 0 && more) o.workers = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--max-sessions") == 0 && more) o.maxSessions = min(65536, max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--queue") == 0 && more) o.queueDepth = min(MAX_QUEUE, max(1, atoi(argv[++i])));
+        else if (strcmp(argv[i], "--jobs") == 0 && more) o.jobs = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--move-ms") == 0 && more) o.moveMs = max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--tt-mb") == 0 && more) transTable.resize(atoi(argv[++i]));
+        else if (strcmp(argv[i], "--cache") == 0 && more) cachePath = argv[++i];
+        else if (strcmp(argv[i], "--cache-mb") == 0 && more) cacheMb = max(1, atoi(argv[++i]));
+        else { fprintf(stderr, "unknown option %s\n", argv[i]); return 1; }
+    }
+    if (cachePath && !searchCache.open(cachePath, cacheMb)) { fprintf(stderr, "cannot use search cache %s\n", cachePath); return 1; }
+    searchThreads = 1;   // parallelism comes from the worker pool, one search per worker
+
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+    signal(SIGPIPE, SIG_IGN);
+    Server server(o);
+    if (!server.open()) return 1;
+    printf("%d workers, up to %d sessions, %d ms per move\n", o.workers, o.maxSessions, o.moveMs);
+    server.run(stopRequested);
+    return 0;
+}